@@ -0,0 +1,88 @@
+// Compares the OBJ parser backends on the bundled models and checks that they agree.
+// Usage: ObjLoadBenchmark [repeats] [file.obj ...]   (run from the repository root)
+#include "ObjLoader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+static bool sameVertex(const Vertex &a, const Vertex &b) {
+    return a.Position == b.Position && a.Normal == b.Normal && a.TexCoords == b.TexCoords;
+}
+
+static bool sameData(const ObjData &a, const ObjData &b) {
+    if (a.materialLibraries != b.materialLibraries || a.meshes.size() != b.meshes.size()) return false;
+    if (a.minBound != b.minBound || a.maxBound != b.maxBound) return false;
+    for (size_t i = 0; i < a.meshes.size(); ++i) {
+        const ObjMesh &x = a.meshes[i];
+        const ObjMesh &y = b.meshes[i];
+        if (x.material != y.material || x.indices != y.indices || x.vertices.size() != y.vertices.size()) return false;
+        if (!std::equal(x.vertices.begin(), x.vertices.end(), y.vertices.begin(), sameVertex)) return false;
+    }
+    return true;
+}
+
+// Average milliseconds per load of path
+static double timeLoad(const std::string &path, ObjBackend backend, int repeats, ObjData &out) {
+    ObjLoader::load(path, backend, out); // Warm the page cache
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < repeats; ++i) ObjLoader::load(path, backend, out);
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / repeats;
+}
+
+int main(int argc, char **argv) {
+    int repeats = argc > 1 ? std::max(1, std::atoi(argv[1])) : 10;
+    std::vector<std::string> paths;
+    for (int i = 2; i < argc; ++i) paths.push_back(argv[i]);
+    if (paths.empty()) {
+        for (const auto &entry : std::filesystem::recursive_directory_iterator("resources/obj")) {
+            if (entry.is_regular_file() && entry.path().extension() == ".obj") paths.push_back(entry.path().string());
+        }
+        std::sort(paths.begin(), paths.end());
+    }
+    if (paths.empty()) {
+        std::printf("no .obj files found (run from the repository root)\n");
+        return 1;
+    }
+
+    const ObjBackend backends[] = { ObjBackend::Stream, ObjBackend::Mapped, ObjBackend::TinyObj };
+    const size_t backendCount = sizeof(backends) / sizeof(backends[0]);
+
+    // Times in ms per load; speedups are against the stream parser, "same" compares every backend with it
+    std::printf("%-44s %10s %10s %8s", "file", "KiB", "vertices", "meshes");
+    for (ObjBackend backend : backends) std::printf(" %10s ms", ObjLoader::backendName(backend));
+    for (size_t b = 1; b < backendCount; ++b) std::printf(" %9s x", ObjLoader::backendName(backends[b]));
+    std::printf(" %6s\n", "same");
+
+    std::vector<double> totals(backendCount, 0.0);
+    bool allSame = true;
+    for (const std::string &path : paths) {
+        std::vector<ObjData> results(backendCount);
+        std::vector<double> times(backendCount);
+        bool same = true;
+        for (size_t b = 0; b < backendCount; ++b) {
+            times[b] = timeLoad(path, backends[b], repeats, results[b]);
+            totals[b] += times[b];
+            same = same && sameData(results[0], results[b]);
+        }
+        allSame = allSame && same;
+
+        size_t vertices = 0;
+        for (const ObjMesh &mesh : results[0].meshes) vertices += mesh.vertices.size();
+        std::printf("%-44s %10.1f %10zu %8zu", path.c_str(), std::filesystem::file_size(path) / 1024.0, vertices, results[0].meshes.size());
+        for (double ms : times) std::printf(" %13.4f", ms);
+        for (size_t b = 1; b < backendCount; ++b) std::printf(" %10.2fx", times[0] / times[b]);
+        std::printf(" %6s\n", same ? "yes" : "NO");
+    }
+
+    std::printf("%-44s %10s %10s %8s", "total", "", "", "");
+    for (double ms : totals) std::printf(" %13.4f", ms);
+    for (size_t b = 1; b < backendCount; ++b) std::printf(" %10.2fx", totals[0] / totals[b]);
+    std::printf(" %6s\n", allSame ? "yes" : "NO");
+    return allSame ? 0 : 1;
+}
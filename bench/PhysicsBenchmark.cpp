@@ -0,0 +1,108 @@
+// Measures how PhysicsSystem::update scales with the number of dynamic bodies.
+// Awake: the crates get a small random push before every step, so none of them can fall asleep
+// and every step runs the full broadphase, narrowphase and solver. Asleep: the same world after
+// it has been left to settle, which is what a quiet level costs.
+// Usage: PhysicsBenchmark [steps] [worker threads]
+#include "PhysicsSystem.h"
+#include "GameObject.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+struct BenchWorld {
+    PhysicsSystem physics;
+    std::vector<std::unique_ptr<GameObject>> objects;
+    std::vector<GameObject *> crates;
+
+    explicit BenchWorld(unsigned workerThreads) : physics(workerThreads) {}
+
+    GameObject *addBox(const glm::vec3 &position, const glm::vec3 &halfExtents, bool isStatic) {
+        auto obj = std::make_unique<GameObject>(nullptr, position);
+        obj->rigidBody = std::make_unique<RigidBody>();
+        obj->rigidBody->isStatic = isStatic;
+        obj->rigidBody->collisionMask = COLLISION_MASK_DEFAULT;
+        obj->collider = std::make_unique<AABB>(-halfExtents, halfExtents);
+        physics.addObject(obj.get(), obj->rigidBody.get(), obj->collider.get());
+        objects.push_back(std::move(obj));
+        return objects.back().get();
+    }
+};
+
+// A closed room with crates stacked in a loose grid, similar to a busy level
+static void buildWorld(BenchWorld &world, int bodyCount) {
+    int side = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(bodyCount))));
+    float roomHalf = side * 0.8f + 2.0f;
+
+    world.addBox(glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(roomHalf, 1.0f, roomHalf), true);
+    world.addBox(glm::vec3(roomHalf + 1.0f, 4.0f, 0.0f), glm::vec3(1.0f, 5.0f, roomHalf), true);
+    world.addBox(glm::vec3(-roomHalf - 1.0f, 4.0f, 0.0f), glm::vec3(1.0f, 5.0f, roomHalf), true);
+    world.addBox(glm::vec3(0.0f, 4.0f, roomHalf + 1.0f), glm::vec3(roomHalf, 5.0f, 1.0f), true);
+    world.addBox(glm::vec3(0.0f, 4.0f, -roomHalf - 1.0f), glm::vec3(roomHalf, 5.0f, 1.0f), true);
+
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> jitter(-0.1f, 0.1f);
+    for (int i = 0; i < bodyCount; ++i) {
+        int x = i % side;
+        int z = (i / side) % side;
+        int y = i / (side * side);
+        glm::vec3 pos((x - side * 0.5f) * 1.6f + jitter(rng), 0.5f + y * 1.2f, (z - side * 0.5f) * 1.6f + jitter(rng));
+        GameObject *crate = world.addBox(pos, glm::vec3(0.5f), false);
+        crate->rigidBody->velocity = glm::vec3(jitter(rng), 0.0f, jitter(rng)) * 10.0f;
+        world.crates.push_back(crate);
+    }
+}
+
+// Runs steps updates and returns the average milliseconds per update. With kick, every crate
+// is pushed before each step (outside the timed part) so it stays above the sleep threshold.
+static double timeSteps(BenchWorld &world, int steps, float dt, bool kick, std::mt19937 &rng) {
+    std::uniform_real_distribution<float> push(-20.0f, 20.0f);
+    double total = 0.0;
+    for (int i = 0; i < steps; ++i) {
+        if (kick) {
+            for (GameObject *crate : world.crates) crate->rigidBody->addForce(glm::vec3(push(rng), 0.0f, push(rng)));
+        }
+        auto start = std::chrono::high_resolution_clock::now();
+        world.physics.update(dt);
+        auto end = std::chrono::high_resolution_clock::now();
+        total += std::chrono::duration<double, std::milli>(end - start).count();
+    }
+    return total / steps;
+}
+
+int main(int argc, char **argv) {
+    int steps = argc > 1 ? std::atoi(argv[1]) : 120;
+    unsigned workerThreads = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : JobSystem::defaultWorkerCount();
+    const float dt = 1.0f / 60.0f;
+    const int bodyCounts[] = { 16, 64, 256, 1024, 2048, 4096 };
+
+    std::printf("worker threads: %u\n", workerThreads);
+    std::printf("%8s %12s %14s %14s %14s %10s %10s %10s %12s %10s\n", "bodies", "awake ms", "brute pairs", "candidates",
+        "narrowphase", "reused", "contacts", "sleeping", "asleep ms", "settled");
+    for (int bodyCount : bodyCounts) {
+        BenchWorld world(workerThreads);
+        buildWorld(world, bodyCount);
+        std::mt19937 rng(42);
+
+        // Warm up: let the broadphase build and the crates land
+        for (int i = 0; i < 30; ++i) world.physics.update(dt);
+
+        double awakeMs = timeSteps(world, steps, dt, true, rng);
+        PhysicsSystem::Stats awake = world.physics.getStats();
+
+        // Settle until everything sleeps (or give up after a while), then time the quiet world
+        for (int i = 0; i < 600 && world.physics.getStats().sleepingBodies < world.crates.size(); ++i) world.physics.update(dt);
+        double asleepMs = timeSteps(world, steps, dt, false, rng);
+        const PhysicsSystem::Stats &asleep = world.physics.getStats();
+
+        size_t n = awake.bodyCount;
+        std::printf("%8d %12.4f %14zu %14zu %14zu %10zu %10zu %10zu %12.4f %10zu\n", bodyCount, awakeMs, n * (n - 1) / 2,
+            awake.candidatePairs, awake.narrowphaseTests, awake.reusedContacts, awake.contacts, awake.sleepingBodies,
+            asleepMs, asleep.sleepingBodies);
+    }
+    return 0;
+}
@@ -7,6 +7,7 @@
 
 #include <iostream>
 #include <cmath>
+#include <string>
 
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -16,8 +17,17 @@ bool firstMouse = true;
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
+// Default simulation rate and the most steps taken in one frame before the simulation slows down
+constexpr float DEFAULT_PHYSICS_RATE = 60.0f;
+constexpr int DEFAULT_MAX_SUBSTEPS = 5;
+// Time per frame spent uploading a streamed level to the GPU
+constexpr double LEVEL_UPLOAD_BUDGET = 0.002;
+// Time per frame spent uploading the startup assets while they stream in
+constexpr double ASSET_UPLOAD_BUDGET = 0.002;
+
 Application::Application(int width, int height, const std::string &title)
-    : width(width), height(height), title(title), window(nullptr), fallbackCamera(glm::vec3(0.0f, 0.0f, 3.0f)) {
+    : width(width), height(height), title(title), window(nullptr), fallbackCamera(glm::vec3(0.0f, 0.0f, 3.0f)),
+    fixedTimestep(1.0f / DEFAULT_PHYSICS_RATE), maxSubsteps(DEFAULT_MAX_SUBSTEPS) {
 }
 
 Application::~Application() {
@@ -74,9 +84,18 @@ bool Application::initialize() {
     scene->lightPos = glm::vec3(0.0f, 15.0f, 0.0f);
 
     // --- Load Resources ---
-    scene->addModelResource("portal_gun", std::make_unique<Model>("resources/obj/portal_gun/portal_gun.obj"));
-    scene->addModelResource("cube", std::make_unique<Model>("resources/obj/wall/cube.obj"));
-    scene->addModelResource("portal_cube", std::make_unique<Model>("resources/obj/portal_cube/portal_cube.obj"));
+    // Decoded on worker threads and uploaded a slice per frame by run(), so the first frame
+    // does not wait for them. The cube is tiny and the portal frame colliders need its bounds
+    // right away, so only its upload is deferred.
+    assetLoader = std::make_unique<AssetLoader>();
+    auto addModel = [this](const std::string &name, const std::string &path, ModelUpload upload) {
+        auto model = std::make_unique<Model>(path, upload);
+        assetLoader->addModel(name, *model, upload == ModelUpload::Deferred);
+        scene->addModelResource(name, std::move(model));
+        };
+    addModel("portal_gun", "resources/obj/portal_gun/portal_gun.obj", ModelUpload::Async);
+    addModel("cube", "resources/obj/wall/cube.obj", ModelUpload::Deferred);
+    addModel("portal_cube", "resources/obj/portal_cube/portal_cube.obj", ModelUpload::Async);
 
     // --- Portal A ---
     scene->portalA = std::make_unique<Portal>(width, height);
@@ -90,7 +109,7 @@ bool Application::initialize() {
     // --- Portal B ---
     scene->portalB = std::make_unique<Portal>(width, height);
     scene->portalB->position = glm::vec3(100.0f, 0.0f, 100.0f);
-    scene->portalB->rotation = glm::vec3(0.0f, 180.0f, 0.0f);
+    scene->portalB->setEulerAngles(glm::vec3(0.0f, 180.0f, 0.0f), EulerOrder::YXZ);
     scene->portalB->scale = glm::vec3(0.8f, 1.4f, 0.005f);
     scene->portalB->name = "PortalB";
     scene->portalB->type = PORTAL_B;
@@ -102,12 +121,11 @@ bool Application::initialize() {
     scene->portalB->setLinkedPortal(scene->portalA.get());
 
     // --- Portal Gun ---
-    scene->portalGun = std::make_unique<PortalGun>(scene->modelResources["portal_gun"].get());
+    scene->portalGun = std::make_unique<PortalGun>(scene->getModel("portal_gun"));
+    scene->getModel("portal_gun")->retain();
     scene->portalGun->position = glm::vec3(0.5f, -0.5f, -1.0f);
     scene->portalGun->scale = glm::vec3(0.05f);
 
-    createScene();
-
     // --- Initialize Skybox ---
     std::vector<std::string> faces = {
         "resources/skybox/right.jpg",
@@ -117,87 +135,36 @@ bool Application::initialize() {
         "resources/skybox/front.jpg",
         "resources/skybox/back.jpg"
     };
-    scene->skybox = std::make_unique<Skybox>(faces);
-
-    // --- Initialize Physics World State ---
-    if (scene->physicsSystem) {
-        scene->physicsSystem->update(0.0f);
-    }
+    scene->skybox = std::make_unique<Skybox>(faces, ModelUpload::Async);
+    assetLoader->addSkybox(*scene->skybox);
+    assetLoader->start();
+
+    // --- Level ---
+    // Streamed once the models it shares are parsed (see run); the simulation waits for it
+    levelStreamer = std::make_unique<LevelStreamer>(*scene);
+    scene->levelCompleted.connect([this] {
+        //change window title to "You Win!"
+        glfwSetWindowTitle(window, "You Win!");
+        });
+    scene->player->storePreviousTransform();
 
     return true;
 }
 
-void Application::createScene(int level) {
-    (void *)level;
-    scene->addModelResource("banner", std::make_unique<Model>("resources/obj/level/banner.obj"));
-    scene->addModelResource("button_flip", std::make_unique<Model>("resources/obj/level/button_flip.obj"));
-    scene->addModelResource("button_goal", std::make_unique<Model>("resources/obj/level/button_goal.obj"));
-    scene->addModelResource("movable", std::make_unique<Model>("resources/obj/level/movable.obj"));
-    scene->addModelResource("wall1", std::make_unique<Model>("resources/obj/level/wall1.obj"));
-    scene->addModelResource("wall2", std::make_unique<Model>("resources/obj/level/wall2.obj"));
-    scene->addModelResource("wall3", std::make_unique<Model>("resources/obj/level/wall3.obj"));
-    scene->addModelResource("wall4_p", std::make_unique<Model>("resources/obj/level/wall4_p.obj"));
-    scene->addModelResource("wall5", std::make_unique<Model>("resources/obj/level/wall5.obj"));
-    scene->addModelResource("wall6_p", std::make_unique<Model>("resources/obj/level/wall6_p.obj"));
-    scene->addModelResource("wall7", std::make_unique<Model>("resources/obj/level/wall7.obj"));
-    scene->addModelResource("wall8", std::make_unique<Model>("resources/obj/level/wall8.obj"));
-    scene->addModelResource("wall9", std::make_unique<Model>("resources/obj/level/wall9.obj"));
-    scene->addModelResource("wall10", std::make_unique<Model>("resources/obj/level/wall10.obj"));
-    scene->addModelResource("wall11_p", std::make_unique<Model>("resources/obj/level/wall11_p.obj"));
-    scene->addModelResource("wall12_p", std::make_unique<Model>("resources/obj/level/wall12_p.obj"));
-
-    auto addStaticObj = [&](const std::string &name, const std::string &modelName, bool canPortal) {
-        auto obj = std::make_unique<GameObject>(scene->modelResources[modelName].get());
-        obj->isTeleportable = false;
-        obj->canOpenPortal = canPortal;
-        // Register physics on the object before moving it into the scene map
-        scene->addPhysics(obj.get(), true);
-        scene->addObject(name, std::move(obj));
-        };
+void Application::setPhysicsRate(float stepsPerSecond, int maxSubsteps) {
+    if (stepsPerSecond <= 0.0f || maxSubsteps < 1) return;
+    fixedTimestep = 1.0f / stepsPerSecond;
+    this->maxSubsteps = maxSubsteps;
+}
+
+std::string Application::levelPath(int level) {
+    return "resources/levels/level" + std::to_string(level) + ".lvl";
+}
 
-    addStaticObj("banner", "banner", false);
-    addStaticObj("wall1", "wall1", false);
-    addStaticObj("wall2", "wall2", false);
-    addStaticObj("wall3", "wall3", false);
-    addStaticObj("wall4", "wall4_p", true);
-    addStaticObj("wall5", "wall5", false);
-    addStaticObj("wall6", "wall6_p", true);
-    addStaticObj("wall7", "wall7", false);
-    addStaticObj("wall8", "wall8", false);
-    addStaticObj("wall9", "wall9", false);
-    addStaticObj("wall10", "wall10", false);
-    addStaticObj("wall11", "wall11_p", true);
-    addStaticObj("wall12", "wall12_p", true);
-
-    auto buttonFlip = std::make_unique<Button>(scene->modelResources["button_flip"].get(), glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(1.0f));
-    buttonFlip->isTeleportable = false;
-    buttonFlip->canOpenPortal = false;
-    scene->addTrigger("button_flip_trigger", buttonFlip->createTrigger());
-    scene->addPhysics(buttonFlip.get(), true);
-    scene->addObject("button_flip", std::move(buttonFlip));
-
-    auto flipWall = std::make_unique<Flip>(scene->modelResources["movable"].get(), glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(1.0f));
-    flipWall->isTeleportable = false;
-    flipWall->canOpenPortal = true;
-    flipWall->setPivot(glm::vec3(0.0f, 0.0f, 0.0f));
-    flipWall->setPosition(glm::vec3(-1.5f, 5.5f, -5.0f));
-    scene->addPhysics(flipWall.get(), true);
-    scene->addObject("flip_wall", std::move(flipWall));
-
-    auto cube = std::make_unique<GameObject>(scene->modelResources["portal_cube"].get());
-    cube->isTeleportable = true;
-    cube->canOpenPortal = false;
-    cube->scale = glm::vec3(0.05f);
-    cube->position = glm::vec3(7.0f, -4.0f, -2.0f);
-    scene->addPhysics(cube.get(), false);
-    scene->addObject("portal_cube", std::move(cube));
-
-    auto button_goal = std::make_unique<Button>(scene->modelResources["button_goal"].get(), glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(1.0f));
-    button_goal->isTeleportable = false;
-    button_goal->canOpenPortal = false;
-    scene->addTrigger("button_goal_trigger", button_goal->createTrigger());
-    scene->addPhysics(button_goal.get(), true);
-    scene->addObject("button_goal", std::move(button_goal));
+void Application::streamLevel(int level) {
+    if (levelStreamer && levelStreamer->request(levelPath(level))) {
+        currentLevel = level;
+    }
 }
 
 void Application::run() {
@@ -218,17 +185,50 @@ void Application::run() {
         input.update();
         processInput(deltaTime);
 
+        // --- Startup Assets ---
+        // The first level shares the startup models, whose bounds its colliders are built from
+        if (!levelRequested && (!assetLoader || assetLoader->isDecoded())) {
+            streamLevel(currentLevel);
+            levelRequested = true;
+        }
+        if (assetLoader && assetLoader->update(ASSET_UPLOAD_BUDGET)) {
+            assetLoader.reset();
+        }
+
+        // --- Level Streaming ---
+        if (levelStreamer && levelStreamer->update(LEVEL_UPLOAD_BUDGET)) {
+            levelLoaded = true;
+            glfwSetWindowTitle(window, title.c_str());
+            for (const auto &obj : scene->objects) {
+                obj->storePreviousTransform();
+                obj->interpolateRenderTransform(1.0f);
+            }
+            if (scene->player) {
+                scene->player->position = glm::vec3(0.0f, 0.0f, 0.0f);
+                scene->player->rigidBody->velocity = glm::vec3(0.0f);
+                scene->player->storePreviousTransform();
+            }
+            checkpoint.capture(*scene);
+        }
+
         // --- Logic Update ---
+        // The simulation advances in fixed steps so it behaves the same at any frame rate.
+        // It holds still until the first level is in, the player would fall forever otherwise.
         Camera &activeCamera = getActiveCamera();
-        scene->update(deltaTime, activeCamera);
-        auto button_goal = scene->objects.find("button_goal");
-        if (button_goal != scene->objects.end()) {
-            Button *btn = dynamic_cast<Button *>(button_goal->second.get());
-            if (btn && btn->getIsPressed()) {
-                //change window title to "You Win!"
-                glfwSetWindowTitle(window, "You Win!");
-            }
+        if (levelLoaded) {
+            accumulator += deltaTime;
         }
+        int substeps = 0;
+        while (accumulator >= fixedTimestep && substeps < maxSubsteps) {
+            scene->update(fixedTimestep, activeCamera);
+            accumulator -= fixedTimestep;
+            substeps++;
+        }
+        // Too far behind: drop the backlog instead of spiralling into ever more steps
+        if (accumulator >= fixedTimestep) {
+            accumulator = std::fmod(accumulator, fixedTimestep);
+        }
+        scene->updateFrame(deltaTime, accumulator / fixedTimestep, activeCamera);
 
         // render
         renderer->render(*scene, activeCamera);
@@ -258,10 +258,18 @@ void Application::processInput(float deltaTime) {
         scene->player->processInput(input, scene.get(), deltaTime);
     }
 
+    if (input.isKeyPressed(GLFW_KEY_L) && levelLoaded) {
+        streamLevel(currentLevel);
+    }
+
+    if (input.isKeyPressed(GLFW_KEY_C)) {
+        checkpoint.capture(*scene);
+    }
+
     if (input.isKeyPressed(GLFW_KEY_T)) {
-        if (scene->player) {
-            scene->player->position = glm::vec3(0.0f, 0.0f, 0.0f);
-            scene->player->rigidBody->velocity = glm::vec3(0.0f);
+        if (checkpoint.restore(*scene)) {
+            accumulator = 0.0f;
+            glfwSetWindowTitle(window, title.c_str());
         }
     }
 }
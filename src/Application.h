@@ -7,6 +7,9 @@
 #include <vector>
 #include "InputManager.h"
 #include "Player.h"
+#include "LevelStreamer.h"
+#include "AssetLoader.h"
+#include "SceneSnapshot.h"
 
 #include <string>
 #include <memory>
@@ -19,13 +22,19 @@ public:
     Application(int width, int height, const std::string &title);
     ~Application();
 
+    // Opens the window and starts loading; the assets and the first level stream in from run()
     bool initialize();
-    void createScene(int level = 1);
+    // Loads the level in the background and swaps it in once ready, the current one keeps running
+    void streamLevel(int level);
     void run();
     void shutdown();
 
+    // Simulation runs at a fixed rate; at most maxSubsteps steps are taken per rendered frame
+    void setPhysicsRate(float stepsPerSecond, int maxSubsteps);
+
 private:
     void processInput(float deltaTime);
+    static std::string levelPath(int level);
 
     static void framebuffer_size_callback(GLFWwindow *window, int width, int height);
     static void mouse_callback(GLFWwindow *window, double xpos, double ypos);
@@ -38,10 +47,22 @@ private:
 
     std::unique_ptr<Renderer> renderer;
     std::unique_ptr<Scene> scene;
+    std::unique_ptr<LevelStreamer> levelStreamer;
+    std::unique_ptr<AssetLoader> assetLoader; // Startup assets, dropped once all are uploaded
+    int currentLevel = 1;
+    bool levelRequested = false; // The first level has been handed to the streamer
+    bool levelLoaded = false; // and swapped in
+    // Taken when a level starts and with C, T puts the scene back to it
+    SceneSnapshot checkpoint;
 
     Camera fallbackCamera;
     Camera &getActiveCamera();
 
     // Input
     InputManager input;
+
+    // Fixed timestep
+    float fixedTimestep;
+    int maxSubsteps;
+    float accumulator = 0.0f;
 };
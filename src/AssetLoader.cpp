@@ -0,0 +1,93 @@
+#include "AssetLoader.h"
+#include "JobSystem.h"
+#include "Model.h"
+#include "Skybox.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+// Decode threads next to the loader thread; the physics and level streaming pools run alongside
+constexpr unsigned DECODE_WORKERS = 2;
+
+AssetLoader::AssetLoader()
+    : jobs(std::make_unique<JobSystem>(std::min(DECODE_WORKERS, JobSystem::defaultWorkerCount()))) {
+}
+
+AssetLoader::~AssetLoader() {
+    if (loader.joinable()) {
+        loader.join();
+    }
+}
+
+void AssetLoader::add(Task task) {
+    if (started) {
+        std::cout << "AssetLoader: " << task.name << " queued after start, ignored" << std::endl;
+        return;
+    }
+    tasks.push_back(std::move(task));
+}
+
+void AssetLoader::addModel(const std::string &name, Model &model, bool parsed) {
+    model.retain();
+    Task task;
+    task.name = name;
+    if (!parsed) {
+        task.decode = [&model] { model.parse(); };
+    }
+    task.uploadStep = [&model] {
+        if (!model.uploadStep()) return false;
+        model.release();
+        return true;
+        };
+    add(std::move(task));
+}
+
+void AssetLoader::addSkybox(Skybox &skybox) {
+    add({ "skybox", [&skybox] { skybox.decodeFaces(); }, [&skybox] { return skybox.uploadStep(); } });
+}
+
+void AssetLoader::start() {
+    if (started) return;
+    started = true;
+    ready.reserve(tasks.size());
+    loader = std::thread([this] {
+        // One task per job: the models and images are few and of very different sizes
+        jobs->parallelFor(tasks.size(), 1, [this](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                if (tasks[i].decode) {
+                    tasks[i].decode();
+                }
+                std::lock_guard<std::mutex> lock(readyMutex);
+                ready.push_back(i);
+            }
+            });
+        decoded.store(true, std::memory_order_release);
+        });
+}
+
+bool AssetLoader::update(double budgetSeconds) {
+    if (!started || finished) return false;
+
+    // At least one step per frame so a tiny budget still makes progress
+    auto start = std::chrono::steady_clock::now();
+    while (uploadedCount < tasks.size()) {
+        if (uploading == NO_TASK) {
+            std::lock_guard<std::mutex> lock(readyMutex);
+            if (nextReady == ready.size()) break; // The rest is still decoding
+            uploading = ready[nextReady++];
+        }
+        if (tasks[uploading].uploadStep()) {
+            uploading = NO_TASK;
+            uploadedCount++;
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed.count() >= budgetSeconds) break;
+    }
+    if (uploadedCount < tasks.size()) return false;
+
+    loader.join();
+    tasks.clear();
+    finished = true;
+    return true;
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class JobSystem;
+class Model;
+class Skybox;
+
+// Loads assets in two stages so frames keep coming while they arrive. After start(), a loader
+// thread runs the CPU half of every queued asset (OBJ parse, stbi_load) across a JobSystem and
+// hands each one over as soon as it is decoded; update() runs the GL half of the ready ones on
+// the main thread, a slice at a time. The assets must outlive the loader.
+class AssetLoader {
+public:
+    struct Task {
+        std::string name;
+        std::function<void()> decode; // Worker thread, no GL and no scene access. Empty: nothing to decode.
+        std::function<bool()> uploadStep; // GL thread, called until it returns true
+    };
+
+    AssetLoader();
+    ~AssetLoader();
+
+    AssetLoader(const AssetLoader &) = delete;
+    AssetLoader &operator=(const AssetLoader &) = delete;
+
+    // Queue before start()
+    void add(Task task);
+    // A ModelUpload::Async model is parsed on a worker, a Deferred one is only uploaded.
+    // The model is retained until it is uploaded, so Scene::unloadUnusedModels leaves it alone.
+    void addModel(const std::string &name, Model &model, bool parsed = false);
+    // A Skybox made with ModelUpload::Async
+    void addSkybox(Skybox &skybox);
+
+    void start();
+
+    // Main thread, once per frame. Spends at most budgetSeconds uploading; returns true on the
+    // frame the last asset finished.
+    bool update(double budgetSeconds);
+
+    // Every decode has finished (e.g. model bounds can be read), some uploads may still be queued
+    bool isDecoded() const { return decoded.load(std::memory_order_acquire); }
+    bool isLoading() const { return started && !finished; }
+
+private:
+    static constexpr size_t NO_TASK = static_cast<size_t>(-1);
+
+    std::unique_ptr<JobSystem> jobs;
+    std::thread loader;
+    std::vector<Task> tasks;
+
+    // Indices into tasks, decoded and waiting for upload, in the order they finished
+    std::mutex readyMutex;
+    std::vector<size_t> ready;
+    size_t nextReady = 0;
+    size_t uploading = NO_TASK; // Task being uploaded, NO_TASK between tasks
+    size_t uploadedCount = 0;
+
+    std::atomic<bool> decoded{ false };
+    bool started = false;
+    bool finished = false;
+};
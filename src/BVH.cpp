@@ -0,0 +1,88 @@
+#include "BVH.h"
+
+#include <algorithm>
+#include <cmath>
+
+void BVH::clear() {
+    nodes.clear();
+    primitives.clear();
+    primitiveIds.clear();
+}
+
+void BVH::build(std::vector<Primitive> prims) {
+    nodes.clear();
+    primitiveIds.clear();
+    primitives = std::move(prims);
+    if (primitives.empty()) return;
+
+    nodes.reserve(primitives.size() * 2);
+    buildRecursive(0, static_cast<int>(primitives.size()));
+
+    primitiveIds.reserve(primitives.size());
+    for (const auto &prim : primitives) {
+        primitiveIds.push_back(prim.userData);
+    }
+}
+
+int BVH::buildRecursive(int first, int count) {
+    int nodeIndex = static_cast<int>(nodes.size());
+    nodes.emplace_back();
+
+    AABB bounds = primitives[first].bounds;
+    glm::vec3 firstCentroid = primitives[first].bounds.min + primitives[first].bounds.max;
+    AABB centroidBounds(firstCentroid, firstCentroid);
+    for (int i = first; i < first + count; ++i) {
+        bounds = AABB::merge(bounds, primitives[i].bounds);
+        glm::vec3 c = primitives[i].bounds.min + primitives[i].bounds.max;
+        centroidBounds.min = glm::min(centroidBounds.min, c);
+        centroidBounds.max = glm::max(centroidBounds.max, c);
+    }
+    nodes[nodeIndex].bounds = bounds;
+
+    if (count <= MaxLeafSize) {
+        nodes[nodeIndex].offset = first;
+        nodes[nodeIndex].count = count;
+        return nodeIndex;
+    }
+
+    // Median split along the axis with the largest centroid spread
+    glm::vec3 extent = centroidBounds.max - centroidBounds.min;
+    int axis = 0;
+    if (extent.y > extent.x) axis = 1;
+    if (extent.z > extent[axis]) axis = 2;
+
+    int mid = first + count / 2;
+    std::nth_element(primitives.begin() + first, primitives.begin() + mid, primitives.begin() + first + count,
+        [axis](const Primitive &a, const Primitive &b) {
+            return a.bounds.min[axis] + a.bounds.max[axis] < b.bounds.min[axis] + b.bounds.max[axis];
+        });
+
+    // Left child is built directly after this node, the right child index is stored in offset
+    buildRecursive(first, mid - first);
+    int right = buildRecursive(mid, first + count - mid);
+    nodes[nodeIndex].offset = right;
+    nodes[nodeIndex].count = 0;
+    return nodeIndex;
+}
+
+bool BVH::rayHitsBounds(const AABB &bounds, const glm::vec3 &origin, const glm::vec3 &invDir, float maxDistance, float &tEntry) {
+    float tmin = 0.0f;
+    float tmax = maxDistance;
+
+    for (int i = 0; i < 3; ++i) {
+        if (std::isinf(invDir[i])) {
+            // Ray parallel to this slab
+            if (origin[i] < bounds.min[i] || origin[i] > bounds.max[i]) return false;
+            continue;
+        }
+        float t1 = (bounds.min[i] - origin[i]) * invDir[i];
+        float t2 = (bounds.max[i] - origin[i]) * invDir[i];
+        if (t1 > t2) std::swap(t1, t2);
+        tmin = std::max(tmin, t1);
+        tmax = std::min(tmax, t2);
+        if (tmin > tmax) return false;
+    }
+
+    tEntry = tmin;
+    return true;
+}
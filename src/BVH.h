@@ -0,0 +1,127 @@
+#pragma once
+
+#include "Collider.h"
+#include "DynamicAABBTree.h"
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Flattened bounding volume hierarchy used for ray queries.
+// Built top-down once from a set of primitives; afterwards the node bounds can be
+// refit in a single bottom-up pass when primitives move without changing the topology.
+class BVH {
+public:
+    struct Primitive {
+        AABB bounds;
+        int userData;
+    };
+
+    static constexpr int MaxLeafSize = 4;
+
+    void build(std::vector<Primitive> primitives);
+    void clear();
+
+    // Recomputes primitive and node bounds. boundsOf(userData) returns the new AABB of a primitive.
+    template <typename BoundsFn>
+    void refit(BoundsFn &&boundsOf);
+
+    // Walks the leaves hit by the ray in roughly front-to-back order.
+    // intersect(const int *userData, int count, maxDistance) tests the (up to MaxLeafSize)
+    // primitives of one leaf and returns the nearest hit distance, or a negative value on a miss.
+    // Hits shrink the search distance; with anyHit the traversal stops at the first hit.
+    // Returns true if any primitive reported a hit.
+    template <typename IntersectFn>
+    bool raycast(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance, bool anyHit, IntersectFn &&intersect) const;
+
+    bool empty() const { return nodes.empty(); }
+    size_t size() const { return primitives.size(); }
+
+private:
+    struct Node {
+        AABB bounds;
+        // Interior: index of the right child (left child is always the next node)
+        // Leaf: index of the first primitive
+        int offset = 0;
+        int count = 0; // Number of primitives, 0 for interior nodes
+
+        bool isLeaf() const { return count > 0; }
+    };
+
+    std::vector<Node> nodes;
+    std::vector<Primitive> primitives;
+    std::vector<int> primitiveIds; // userData of primitives, contiguous per leaf
+
+    int buildRecursive(int first, int count);
+
+    static bool rayHitsBounds(const AABB &bounds, const glm::vec3 &origin, const glm::vec3 &invDir, float maxDistance, float &tEntry);
+};
+
+template <typename BoundsFn>
+void BVH::refit(BoundsFn &&boundsOf) {
+    for (auto &prim : primitives) {
+        prim.bounds = boundsOf(prim.userData);
+    }
+
+    // Children are always stored after their parent, so a reverse sweep is bottom-up
+    for (int i = static_cast<int>(nodes.size()) - 1; i >= 0; --i) {
+        Node &node = nodes[i];
+        if (node.isLeaf()) {
+            node.bounds = primitives[node.offset].bounds;
+            for (int p = 1; p < node.count; ++p) {
+                node.bounds = AABB::merge(node.bounds, primitives[node.offset + p].bounds);
+            }
+        } else {
+            node.bounds = AABB::merge(nodes[i + 1].bounds, nodes[node.offset].bounds);
+        }
+    }
+}
+
+template <typename IntersectFn>
+bool BVH::raycast(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance, bool anyHit, IntersectFn &&intersect) const {
+    if (nodes.empty()) return false;
+
+    glm::vec3 invDir = 1.0f / direction;
+    bool hitAny = false;
+
+    TraversalStack stack;
+    stack.push(0);
+
+    while (!stack.empty()) {
+        const Node &node = nodes[stack.pop()];
+
+        float tEntry;
+        if (!rayHitsBounds(node.bounds, origin, invDir, maxDistance, tEntry)) continue;
+
+        if (node.isLeaf()) {
+            float t = intersect(&primitiveIds[node.offset], node.count, maxDistance);
+            if (t >= 0.0f && t <= maxDistance) {
+                hitAny = true;
+                if (anyHit) return true;
+                maxDistance = t;
+            }
+        } else {
+            // Visit the nearer child first so later boxes can be culled by the shrunken distance
+            int left = static_cast<int>(&node - nodes.data()) + 1;
+            int right = node.offset;
+            float tLeft, tRight;
+            bool hitLeft = rayHitsBounds(nodes[left].bounds, origin, invDir, maxDistance, tLeft);
+            bool hitRight = rayHitsBounds(nodes[right].bounds, origin, invDir, maxDistance, tRight);
+            if (hitLeft && hitRight) {
+                if (tLeft <= tRight) {
+                    stack.push(right);
+                    stack.push(left);
+                } else {
+                    stack.push(left);
+                    stack.push(right);
+                }
+            } else if (hitLeft) {
+                stack.push(left);
+            } else if (hitRight) {
+                stack.push(right);
+            }
+        }
+    }
+
+    return hitAny;
+}
@@ -46,8 +46,14 @@ std::unique_ptr<Trigger> Button::createTrigger() {
 }
 
 void Button::update(float dt, const Camera &camera) {
-    lastPressedState = isPressed;
+    bool wasPressed = isPressed;
     isPressed = (objectsOnButton > 0);
+    if (isPressed && !wasPressed) {
+        pressed.emit();
+    } else if (!isPressed && wasPressed) {
+        released.emit();
+    }
+
     glm::vec3 target = isPressed ? pressedPosition : initialPosition;
 
     glm::vec3 diff = target - position;
@@ -63,10 +69,3 @@ void Button::update(float dt, const Camera &camera) {
     }
 }
 
-bool Button::getIsPressed() {
-    return (lastPressedState != isPressed && isPressed);
-}
-
-bool Button::getIsReleased() {
-    return (lastPressedState != isPressed && !isPressed);
-}
@@ -2,6 +2,7 @@
 
 #include "GameObject.h"
 #include "Trigger.h"
+#include "Signal.h"
 
 #include <memory>
 
@@ -15,14 +16,24 @@ public:
 
     void update(float dt, const Camera &camera) override;
 
-    bool getIsPressed();
-
-    bool getIsReleased();
+    // Emitted from update() on the step the button goes down / comes back up
+    Signal<> pressed;
+    Signal<> released;
+
+    // Dynamic state, saved and restored by SceneSnapshot
+    struct State {
+        bool isPressed;
+        int objectsOnButton;
+    };
+    State getState() const { return { isPressed, objectsOnButton }; }
+    void setState(const State &state) {
+        isPressed = state.isPressed;
+        objectsOnButton = state.objectsOnButton;
+    }
 
 private:
     glm::vec3 initialPosition;
     glm::vec3 pressedPosition;
-    bool lastPressedState = false;
     bool isPressed = false;
     int objectsOnButton = 0;
     float pressSpeed = 1.0f; // Units per second
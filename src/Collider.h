@@ -0,0 +1,57 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// Basic AABB Collider
+struct AABB {
+    glm::vec3 min;
+    glm::vec3 max;
+
+    AABB(const glm::vec3 &min = glm::vec3(0.0f), const glm::vec3 &max = glm::vec3(0.0f))
+        : min(min), max(max) {
+    }
+
+    bool overlaps(const AABB &other) const {
+        return min.x <= other.max.x && max.x >= other.min.x &&
+            min.y <= other.max.y && max.y >= other.min.y &&
+            min.z <= other.max.z && max.z >= other.min.z;
+    }
+
+    bool contains(const AABB &other) const {
+        return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z &&
+            max.x >= other.max.x && max.y >= other.max.y && max.z >= other.max.z;
+    }
+
+    // Half of the surface area, used as the insertion cost metric of the broadphase tree
+    float perimeter() const {
+        glm::vec3 d = max - min;
+        return d.x * d.y + d.y * d.z + d.z * d.x;
+    }
+
+    static AABB merge(const AABB &a, const AABB &b) {
+        return AABB(glm::min(a.min, b.min), glm::max(a.max, b.max));
+    }
+};
+
+// Oriented Bounding Box
+struct OBB {
+    glm::vec3 center;
+    glm::vec3 axes[3]; // Local x, y, z axes in world space (normalized)
+    glm::vec3 halfExtents;
+
+    OBB() {}
+    OBB(const glm::vec3 &center, const glm::vec3 axes[3], const glm::vec3 &halfExtents)
+        : center(center), halfExtents(halfExtents) {
+        this->axes[0] = axes[0];
+        this->axes[1] = axes[1];
+        this->axes[2] = axes[2];
+    }
+
+    // World space AABB enclosing this box
+    AABB getBounds() const {
+        glm::vec3 extent = glm::abs(axes[0]) * halfExtents.x +
+            glm::abs(axes[1]) * halfExtents.y +
+            glm::abs(axes[2]) * halfExtents.z;
+        return AABB(center - extent, center + extent);
+    }
+};
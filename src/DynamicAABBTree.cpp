@@ -0,0 +1,284 @@
+#include "DynamicAABBTree.h"
+
+#include <algorithm>
+#include <cassert>
+
+DynamicAABBTree::DynamicAABBTree(float margin) : margin(margin) {}
+
+int DynamicAABBTree::allocateNode() {
+    if (freeList == NullNode) {
+        nodes.emplace_back();
+        return static_cast<int>(nodes.size()) - 1;
+    }
+
+    int nodeId = freeList;
+    freeList = nodes[nodeId].parent;
+    nodes[nodeId] = Node();
+    return nodeId;
+}
+
+void DynamicAABBTree::freeNode(int nodeId) {
+    nodes[nodeId].parent = freeList;
+    nodes[nodeId].height = -1;
+    freeList = nodeId;
+}
+
+int DynamicAABBTree::createProxy(const AABB &aabb, int userData) {
+    int proxyId = allocateNode();
+
+    glm::vec3 r(margin);
+    nodes[proxyId].aabb = AABB(aabb.min - r, aabb.max + r);
+    nodes[proxyId].userData = userData;
+    nodes[proxyId].height = 0;
+
+    insertLeaf(proxyId);
+    proxyCount++;
+    return proxyId;
+}
+
+void DynamicAABBTree::destroyProxy(int proxyId) {
+    assert(nodes[proxyId].isLeaf());
+    removeLeaf(proxyId);
+    freeNode(proxyId);
+    proxyCount--;
+}
+
+bool DynamicAABBTree::moveProxy(int proxyId, const AABB &aabb, const glm::vec3 &displacement) {
+    assert(nodes[proxyId].isLeaf());
+
+    if (nodes[proxyId].aabb.contains(aabb)) {
+        return false;
+    }
+
+    removeLeaf(proxyId);
+
+    // Enlarge by the margin and extend along the predicted displacement
+    glm::vec3 r(margin);
+    AABB fat(aabb.min - r, aabb.max + r);
+    glm::vec3 d = displacement * 2.0f;
+    fat.min += glm::min(d, glm::vec3(0.0f));
+    fat.max += glm::max(d, glm::vec3(0.0f));
+    nodes[proxyId].aabb = fat;
+
+    insertLeaf(proxyId);
+    return true;
+}
+
+void DynamicAABBTree::insertLeaf(int leaf) {
+    if (root == NullNode) {
+        root = leaf;
+        nodes[root].parent = NullNode;
+        return;
+    }
+
+    // Find the best sibling using the surface area heuristic
+    AABB leafAABB = nodes[leaf].aabb;
+    int index = root;
+    while (!nodes[index].isLeaf()) {
+        int child1 = nodes[index].child1;
+        int child2 = nodes[index].child2;
+
+        float area = nodes[index].aabb.perimeter();
+        float combinedArea = AABB::merge(nodes[index].aabb, leafAABB).perimeter();
+
+        // Cost of creating a new parent for this node and the new leaf
+        float cost = 2.0f * combinedArea;
+        // Minimum cost of pushing the leaf further down the tree
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        auto descendCost = [&](int child) {
+            float merged = AABB::merge(leafAABB, nodes[child].aabb).perimeter();
+            if (nodes[child].isLeaf()) {
+                return merged + inheritanceCost;
+            }
+            return merged - nodes[child].aabb.perimeter() + inheritanceCost;
+            };
+
+        float cost1 = descendCost(child1);
+        float cost2 = descendCost(child2);
+
+        if (cost < cost1 && cost < cost2) break;
+
+        index = cost1 < cost2 ? child1 : child2;
+    }
+
+    int sibling = index;
+
+    // Create a new parent
+    int oldParent = nodes[sibling].parent;
+    int newParent = allocateNode();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].aabb = AABB::merge(leafAABB, nodes[sibling].aabb);
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[newParent].child1 = sibling;
+    nodes[newParent].child2 = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    if (oldParent != NullNode) {
+        if (nodes[oldParent].child1 == sibling) {
+            nodes[oldParent].child1 = newParent;
+        } else {
+            nodes[oldParent].child2 = newParent;
+        }
+    } else {
+        root = newParent;
+    }
+
+    // Walk back up the tree fixing heights and AABBs
+    index = nodes[leaf].parent;
+    while (index != NullNode) {
+        index = balance(index);
+
+        int child1 = nodes[index].child1;
+        int child2 = nodes[index].child2;
+        nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+        nodes[index].aabb = AABB::merge(nodes[child1].aabb, nodes[child2].aabb);
+
+        index = nodes[index].parent;
+    }
+}
+
+void DynamicAABBTree::removeLeaf(int leaf) {
+    if (leaf == root) {
+        root = NullNode;
+        return;
+    }
+
+    int parent = nodes[leaf].parent;
+    int grandParent = nodes[parent].parent;
+    int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+    if (grandParent != NullNode) {
+        // Destroy parent and connect sibling to grandParent
+        if (nodes[grandParent].child1 == parent) {
+            nodes[grandParent].child1 = sibling;
+        } else {
+            nodes[grandParent].child2 = sibling;
+        }
+        nodes[sibling].parent = grandParent;
+        freeNode(parent);
+
+        int index = grandParent;
+        while (index != NullNode) {
+            index = balance(index);
+
+            int child1 = nodes[index].child1;
+            int child2 = nodes[index].child2;
+            nodes[index].aabb = AABB::merge(nodes[child1].aabb, nodes[child2].aabb);
+            nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+
+            index = nodes[index].parent;
+        }
+    } else {
+        root = sibling;
+        nodes[sibling].parent = NullNode;
+        freeNode(parent);
+    }
+}
+
+// Performs a left or right rotation if node A is imbalanced.
+// Returns the new root index of the subtree.
+int DynamicAABBTree::balance(int iA) {
+    Node &A = nodes[iA];
+    if (A.isLeaf() || A.height < 2) {
+        return iA;
+    }
+
+    int iB = A.child1;
+    int iC = A.child2;
+    Node &B = nodes[iB];
+    Node &C = nodes[iC];
+
+    int heightDiff = C.height - B.height;
+
+    // Rotate C up
+    if (heightDiff > 1) {
+        int iF = C.child1;
+        int iG = C.child2;
+        Node &F = nodes[iF];
+        Node &G = nodes[iG];
+
+        // Swap A and C
+        C.child1 = iA;
+        C.parent = A.parent;
+        A.parent = iC;
+
+        if (C.parent != NullNode) {
+            if (nodes[C.parent].child1 == iA) {
+                nodes[C.parent].child1 = iC;
+            } else {
+                nodes[C.parent].child2 = iC;
+            }
+        } else {
+            root = iC;
+        }
+
+        // Rotate
+        if (F.height > G.height) {
+            C.child2 = iF;
+            A.child2 = iG;
+            G.parent = iA;
+            A.aabb = AABB::merge(B.aabb, G.aabb);
+            C.aabb = AABB::merge(A.aabb, F.aabb);
+            A.height = 1 + std::max(B.height, G.height);
+            C.height = 1 + std::max(A.height, F.height);
+        } else {
+            C.child2 = iG;
+            A.child2 = iF;
+            F.parent = iA;
+            A.aabb = AABB::merge(B.aabb, F.aabb);
+            C.aabb = AABB::merge(A.aabb, G.aabb);
+            A.height = 1 + std::max(B.height, F.height);
+            C.height = 1 + std::max(A.height, G.height);
+        }
+
+        return iC;
+    }
+
+    // Rotate B up
+    if (heightDiff < -1) {
+        int iD = B.child1;
+        int iE = B.child2;
+        Node &D = nodes[iD];
+        Node &E = nodes[iE];
+
+        // Swap A and B
+        B.child1 = iA;
+        B.parent = A.parent;
+        A.parent = iB;
+
+        if (B.parent != NullNode) {
+            if (nodes[B.parent].child1 == iA) {
+                nodes[B.parent].child1 = iB;
+            } else {
+                nodes[B.parent].child2 = iB;
+            }
+        } else {
+            root = iB;
+        }
+
+        // Rotate
+        if (D.height > E.height) {
+            B.child2 = iD;
+            A.child1 = iE;
+            E.parent = iA;
+            A.aabb = AABB::merge(C.aabb, E.aabb);
+            B.aabb = AABB::merge(A.aabb, D.aabb);
+            A.height = 1 + std::max(C.height, E.height);
+            B.height = 1 + std::max(A.height, D.height);
+        } else {
+            B.child2 = iE;
+            A.child1 = iD;
+            D.parent = iA;
+            A.aabb = AABB::merge(C.aabb, D.aabb);
+            B.aabb = AABB::merge(A.aabb, E.aabb);
+            A.height = 1 + std::max(C.height, D.height);
+            B.height = 1 + std::max(A.height, E.height);
+        }
+
+        return iB;
+    }
+
+    return iA;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "Collider.h"
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Small stack for tree traversal: lives on the call stack and only touches the heap
+// for unusually deep trees. Queries keep their own stack so they can run concurrently.
+class TraversalStack {
+public:
+    void push(int value) {
+        if (count < FixedCapacity) {
+            fixed[count++] = value;
+        } else {
+            overflow.push_back(value);
+        }
+    }
+
+    int pop() {
+        if (!overflow.empty()) {
+            int value = overflow.back();
+            overflow.pop_back();
+            return value;
+        }
+        return fixed[--count];
+    }
+
+    bool empty() const { return count == 0 && overflow.empty(); }
+
+private:
+    static constexpr int FixedCapacity = 128;
+    int fixed[FixedCapacity];
+    int count = 0;
+    std::vector<int> overflow;
+};
+
+// Dynamic AABB tree used as the physics broadphase.
+// Leaves store "fat" AABBs (enlarged by a margin and the predicted displacement)
+// so that small movements do not require the proxy to be re-inserted every step.
+class DynamicAABBTree {
+public:
+    static constexpr int NullNode = -1;
+
+    explicit DynamicAABBTree(float margin = 0.1f);
+
+    // Creates a leaf for the given tight AABB and returns its proxy id.
+    int createProxy(const AABB &aabb, int userData);
+    void destroyProxy(int proxyId);
+
+    // Updates a proxy with its new tight AABB.
+    // Returns true if the proxy left its fat AABB and had to be re-inserted.
+    bool moveProxy(int proxyId, const AABB &aabb, const glm::vec3 &displacement = glm::vec3(0.0f));
+
+    int getUserData(int proxyId) const { return nodes[proxyId].userData; }
+    void setUserData(int proxyId, int userData) { nodes[proxyId].userData = userData; }
+    const AABB &getFatAABB(int proxyId) const { return nodes[proxyId].aabb; }
+
+    // Calls callback(proxyId) for every leaf whose fat AABB overlaps the query box.
+    // The callback returns false to stop the query early.
+    template <typename Callback>
+    void query(const AABB &aabb, Callback &&callback) const;
+
+    // Makes room for proxyCount leaves and their internal nodes
+    void reserve(int proxyCount) { nodes.reserve(static_cast<size_t>(proxyCount) * 2); }
+
+    int getHeight() const { return root == NullNode ? 0 : nodes[root].height; }
+    int getProxyCount() const { return proxyCount; }
+
+private:
+    struct Node {
+        AABB aabb;
+        int userData = -1;
+        int parent = NullNode; // Doubles as the next pointer while on the free list
+        int child1 = NullNode;
+        int child2 = NullNode;
+        int height = -1; // Leaf = 0, free node = -1
+
+        bool isLeaf() const { return child1 == NullNode; }
+    };
+
+    std::vector<Node> nodes;
+    int root = NullNode;
+    int freeList = NullNode;
+    int proxyCount = 0;
+    float margin;
+
+    int allocateNode();
+    void freeNode(int nodeId);
+
+    void insertLeaf(int leaf);
+    void removeLeaf(int leaf);
+    int balance(int nodeId);
+};
+
+template <typename Callback>
+void DynamicAABBTree::query(const AABB &aabb, Callback &&callback) const {
+    if (root == NullNode) return;
+
+    TraversalStack stack;
+    stack.push(root);
+
+    while (!stack.empty()) {
+        int nodeId = stack.pop();
+
+        const Node &node = nodes[nodeId];
+        if (!node.aabb.overlaps(aabb)) continue;
+
+        if (node.isLeaf()) {
+            if (!callback(nodeId)) return;
+        } else {
+            stack.push(node.child1);
+            stack.push(node.child2);
+        }
+    }
+}
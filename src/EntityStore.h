@@ -0,0 +1,177 @@
+#pragma once
+
+#include "ObjectPool.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Reference to an entry of a SlotMap. The generation changes every time a slot is freed,
+// so a handle to a removed entry stays invalid even after its slot is reused.
+struct EntityHandle {
+    static constexpr uint32_t InvalidIndex = UINT32_MAX;
+
+    uint32_t index = InvalidIndex;
+    uint32_t generation = 0;
+
+    bool isValid() const { return index != InvalidIndex; }
+    bool operator==(const EntityHandle &other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const EntityHandle &other) const { return !(*this == other); }
+};
+
+// Generational slot map: values are packed in one dense array so iteration is a linear walk,
+// handles go through a slot table. Insert and remove are O(1); removal moves the last value
+// into the hole, which changes the iteration order but never invalidates other handles.
+template <typename T>
+class SlotMap {
+public:
+    EntityHandle insert(T value) {
+        uint32_t slotIndex;
+        if (!freeSlots.empty()) {
+            slotIndex = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            slotIndex = static_cast<uint32_t>(slots.size());
+            slots.push_back(Slot());
+        }
+
+        slots[slotIndex].denseIndex = static_cast<uint32_t>(dense.size());
+        dense.push_back(std::move(value));
+        denseToSlot.push_back(slotIndex);
+        return EntityHandle{ slotIndex, slots[slotIndex].generation };
+    }
+
+    bool remove(EntityHandle handle) {
+        if (!contains(handle)) return false;
+
+        uint32_t denseIndex = slots[handle.index].denseIndex;
+        uint32_t lastIndex = static_cast<uint32_t>(dense.size() - 1);
+        if (denseIndex != lastIndex) {
+            dense[denseIndex] = std::move(dense[lastIndex]);
+            denseToSlot[denseIndex] = denseToSlot[lastIndex];
+            slots[denseToSlot[denseIndex]].denseIndex = denseIndex;
+        }
+        dense.pop_back();
+        denseToSlot.pop_back();
+
+        slots[handle.index].generation++;
+        slots[handle.index].denseIndex = EntityHandle::InvalidIndex;
+        freeSlots.push_back(handle.index);
+        return true;
+    }
+
+    void reserve(size_t count) {
+        dense.reserve(count);
+        denseToSlot.reserve(count);
+        slots.reserve(count);
+    }
+
+    bool contains(EntityHandle handle) const {
+        return handle.index < slots.size() && slots[handle.index].generation == handle.generation
+            && slots[handle.index].denseIndex != EntityHandle::InvalidIndex;
+    }
+
+    T *get(EntityHandle handle) { return contains(handle) ? &dense[slots[handle.index].denseIndex] : nullptr; }
+    const T *get(EntityHandle handle) const { return contains(handle) ? &dense[slots[handle.index].denseIndex] : nullptr; }
+
+    // Handle of the value at a position of the dense array
+    EntityHandle handleAt(size_t denseIndex) const {
+        uint32_t slotIndex = denseToSlot[denseIndex];
+        return EntityHandle{ slotIndex, slots[slotIndex].generation };
+    }
+
+    size_t size() const { return dense.size(); }
+    bool empty() const { return dense.empty(); }
+
+    const std::vector<T> &values() const { return dense; }
+    typename std::vector<T>::iterator begin() { return dense.begin(); }
+    typename std::vector<T>::iterator end() { return dense.end(); }
+    typename std::vector<T>::const_iterator begin() const { return dense.begin(); }
+    typename std::vector<T>::const_iterator end() const { return dense.end(); }
+
+private:
+    struct Slot {
+        uint32_t denseIndex = EntityHandle::InvalidIndex;
+        uint32_t generation = 0;
+    };
+
+    std::vector<T> dense;
+    std::vector<uint32_t> denseToSlot;
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+};
+
+// Owning store of named scene entities (objects, triggers, models).
+// Per-frame loops walk the dense array; names are only a side table for setup-time lookups.
+// Entities may come from an ObjectPool or from the heap, PoolPtr frees either kind.
+template <typename T>
+class EntityStore {
+public:
+    // Returns an invalid handle if the name is already taken. An empty name adds an anonymous
+    // entity, reachable by handle only, which keeps the name table (and its allocations) out
+    // of spawning.
+    EntityHandle add(const std::string &name, PoolPtr<T> entity) {
+        if (!name.empty() && names.count(name)) return EntityHandle();
+        EntityHandle handle = entities.insert(std::move(entity));
+        if (handle.index >= slotNames.size()) {
+            slotNames.resize(handle.index + 1);
+        }
+        if (!name.empty()) {
+            slotNames[handle.index] = name;
+            names[name] = handle;
+        }
+        return handle;
+    }
+
+    bool remove(EntityHandle handle) {
+        if (!entities.contains(handle)) return false;
+        if (!slotNames[handle.index].empty()) {
+            names.erase(slotNames[handle.index]);
+            slotNames[handle.index].clear();
+        }
+        return entities.remove(handle);
+    }
+
+    // Makes room for count entities in total, so bulk loads do not regrow the arrays
+    void reserve(size_t count) {
+        entities.reserve(count);
+        names.reserve(count);
+        slotNames.reserve(count);
+    }
+
+    bool contains(const std::string &name) const { return names.count(name) > 0; }
+
+    EntityHandle findHandle(const std::string &name) const {
+        auto it = names.find(name);
+        return it != names.end() ? it->second : EntityHandle();
+    }
+
+    T *get(EntityHandle handle) const {
+        const PoolPtr<T> *entity = entities.get(handle);
+        return entity ? entity->get() : nullptr;
+    }
+
+    T *find(const std::string &name) const { return get(findHandle(name)); }
+
+    // Empty for anonymous entities and for stale or invalid handles
+    const std::string &nameOf(EntityHandle handle) const {
+        static const std::string noName;
+        return entities.contains(handle) ? slotNames[handle.index] : noName;
+    }
+
+    size_t size() const { return entities.size(); }
+    EntityHandle handleAt(size_t denseIndex) const { return entities.handleAt(denseIndex); }
+
+    // Dense array, index i is the entity at handleAt(i)
+    const std::vector<PoolPtr<T>> &values() const { return entities.values(); }
+    auto begin() const { return entities.begin(); }
+    auto end() const { return entities.end(); }
+
+private:
+    SlotMap<PoolPtr<T>> entities;
+    std::unordered_map<std::string, EntityHandle> names;
+    std::vector<std::string> slotNames; // By slot index
+};
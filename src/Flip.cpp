@@ -1,18 +1,15 @@
 #include "Flip.h"
-#include <glm/gtx/quaternion.hpp>
-#include <glm/gtx/matrix_decompose.hpp>
+
+#include <cmath>
+
+#include <glm/gtc/quaternion.hpp>
 
 Flip::Flip(Model *model, glm::vec3 pos, glm::vec3 rot, glm::vec3 scale)
     : GameObject(model, pos, rot, scale) {
     initialPosition = pos;
-    initialRotation = rot;
-
-    glm::quat qx = glm::angleAxis(glm::radians(initialRotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-    glm::quat qy = glm::angleAxis(glm::radians(initialRotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-    glm::quat qz = glm::angleAxis(glm::radians(initialRotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
-    glm::quat qInit = qx * qy * qz;
+    initialOrientation = orientation;
 
-    rotationAxis = qInit * glm::vec3(0.0f, 0.0f, 1.0f);
+    rotationAxis = initialOrientation * glm::vec3(0.0f, 0.0f, 1.0f);
     maxAngle = 45.0f;
 
     glm::vec3 center = model->getCenter();
@@ -42,7 +39,10 @@ void Flip::update(float dt, const Camera &camera) {
         isRotating = false;
     } else {
         canOpenPortal = false;
-        isRotating = true;
+        if (!isRotating) {
+            isRotating = true;
+            rotationStarted.emit();
+        }
         float step = speed * dt;
         if (currentAngle < targetAngle) {
             currentAngle += step;
@@ -53,23 +53,10 @@ void Flip::update(float dt, const Camera &camera) {
         }
     }
 
-    glm::mat4 initModel = glm::mat4(1.0f);
-    initModel = glm::translate(initModel, initialPosition);
-    initModel = glm::rotate(initModel, glm::radians(initialRotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-    initModel = glm::rotate(initModel, glm::radians(initialRotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-    initModel = glm::rotate(initModel, glm::radians(initialRotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
-    glm::vec3 pivotWorld = initialPosition +
-        glm::quat(glm::radians(initialRotation)) * (pivotLocal * scale);
+    glm::vec3 pivotWorld = initialPosition + initialOrientation * (pivotLocal * scale);
 
-    // Rotation Quaternion
+    // Swing around the pivot: R_new = qRot * R_init
     glm::quat qRot = glm::angleAxis(glm::radians(currentAngle), rotationAxis);
-
-    // New Rotation
-    // R_new = qRot * R_init
-    glm::quat qInit = glm::quat(glm::radians(initialRotation));
-    glm::quat qFinal = qRot * qInit;
-
-    glm::vec3 centerNew = pivotWorld + qRot * (initialPosition - pivotWorld);
-    this->position = centerNew;
-    this->rotation = initialRotation + rotationAxis * currentAngle;
+    this->position = pivotWorld + qRot * (initialPosition - pivotWorld);
+    this->orientation = qRot * initialOrientation;
 }
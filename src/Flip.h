@@ -1,7 +1,10 @@
 #pragma once
 
 #include "GameObject.h"
+#include "Signal.h"
+
 #include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
 
 class Flip : public GameObject {
 public:
@@ -17,9 +20,25 @@ public:
     void setSpeed(float speed);
     bool getIsRotating() const { return isRotating; }
 
+    // Emitted on the step the wall starts moving towards a new angle
+    Signal<> rotationStarted;
+
+    // Dynamic state, saved and restored by SceneSnapshot
+    struct State {
+        float currentAngle;
+        float targetAngle;
+        bool isRotating;
+    };
+    State getState() const { return { currentAngle, targetAngle, isRotating }; }
+    void setState(const State &state) {
+        currentAngle = state.currentAngle;
+        targetAngle = state.targetAngle;
+        isRotating = state.isRotating;
+    }
+
 private:
     glm::vec3 initialPosition;
-    glm::vec3 initialRotation;
+    glm::quat initialOrientation;
 
     glm::vec3 pivotLocal;
     glm::vec3 rotationAxis;
@@ -2,7 +2,8 @@
 #include "PhysicsSystem.h"
 
 GameObject::GameObject(Model *model, glm::vec3 pos, glm::vec3 rot, glm::vec3 scale)
-    : model(model), position(pos), rotation(rot), scale(scale) {
+    : position(pos), orientation(Transform::eulerToQuat(rot, EulerOrder::XYZ)), scale(scale),
+    previousPosition(pos), previousOrientation(orientation), previousScale(scale), model(model) {
 }
 
 GameObject::~GameObject() = default;
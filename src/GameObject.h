@@ -3,6 +3,11 @@
 #include "Model.h"
 #include "Shader.h"
 #include "Camera.h"
+#include "Transform.h"
+#include "ObjectPool.h"
+#include "EntityStore.h"
+
+#include <memory>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -15,20 +20,31 @@ struct AABB;
 class GameObject {
 public:
     std::string name;
+    // The object's own handle in Scene::objects, set by Scene::addObject (spawned objects have no name)
+    EntityHandle handle;
     bool isTeleportable = false;
     bool canOpenPortal = false;
+    // Dense index into the scene's trigger body list, -1 while triggers ignore this object
+    int triggerBodyId = -1;
     // Transform attributes
     glm::vec3 position = glm::vec3(0.0f);
-    glm::vec3 rotation = glm::vec3(0.0f); // Euler angles in degrees
+    glm::quat orientation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
     glm::vec3 scale = glm::vec3(1.0f);
 
+    // Pose at the start of the current fixed step, rendering blends from it towards the pose above
+    glm::vec3 previousPosition = glm::vec3(0.0f);
+    glm::quat previousOrientation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    glm::vec3 previousScale = glm::vec3(1.0f);
+
     // Model reference (does not own the model)
     Model *model;
 
-    // Physics components (owned by GameObject for now, but managed by PhysicsSystem)
-    std::unique_ptr<RigidBody> rigidBody;
-    std::unique_ptr<AABB> collider;
+    // Physics components (owned by GameObject for now, but managed by PhysicsSystem).
+    // Taken from the scene's pools by Scene::addPhysics, from the heap otherwise.
+    PoolPtr<RigidBody> rigidBody;
+    PoolPtr<AABB> collider;
 
+    // rot is in Euler degrees, applied as Rx * Ry * Rz
     GameObject(Model *model, glm::vec3 pos = glm::vec3(0.0f), glm::vec3 rot = glm::vec3(0.0f), glm::vec3 scale = glm::vec3(1.0f));
 
     virtual ~GameObject();
@@ -42,21 +58,39 @@ public:
     virtual void draw(Shader &shader) {
         if (!model) return;
 
-        // 1. Calculate Model Matrix
-        glm::mat4 modelMatrix = glm::mat4(1.0f);
-        modelMatrix = glm::translate(modelMatrix, position);
-        modelMatrix = glm::rotate(modelMatrix, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-        modelMatrix = glm::rotate(modelMatrix, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-        modelMatrix = glm::rotate(modelMatrix, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
-        modelMatrix = glm::scale(modelMatrix, scale);
+        // 1. Pass the interpolated model matrix to the shader
+        shader.setMat4("model", renderTransform.getMatrix());
 
-        // 2. Pass to Shader
-        shader.setMat4("model", modelMatrix);
-
-        // 3. Draw model
+        // 2. Draw model
         model->Draw(shader);
     }
 
+    // World transform built from position/orientation/scale, recomputed only when one of them changed
+    const Transform &getTransform() {
+        transform.update(position, orientation, scale);
+        return transform;
+    }
+
+    // Euler view of the orientation in degrees, for authoring and debugging only
+    glm::vec3 getEulerAngles(EulerOrder order = EulerOrder::XYZ) const { return Transform::quatToEuler(orientation, order); }
+    void setEulerAngles(const glm::vec3 &degrees, EulerOrder order = EulerOrder::XYZ) { orientation = Transform::eulerToQuat(degrees, order); }
+
+    // Called before every fixed step. Also call it after teleporting an object so it is
+    // not drawn sweeping between the old and new place.
+    void storePreviousTransform() {
+        previousPosition = position;
+        previousOrientation = orientation;
+        previousScale = scale;
+    }
+
+    // Places the drawn pose alpha (0..1) of the way from the previous to the current step
+    void interpolateRenderTransform(float alpha) {
+        // prev + (cur - prev) * alpha is exact for objects that did not move, so their cache stays valid
+        renderTransform.update(previousPosition + (position - previousPosition) * alpha,
+            previousOrientation == orientation ? orientation : nlerp(previousOrientation, orientation, alpha),
+            previousScale + (scale - previousScale) * alpha);
+    }
+
     // Helper to set uniform scale based on desired X-axis size
     void setScaleToSizeX(float sizeX);
 
@@ -65,4 +99,15 @@ public:
 
     // Helper to enable/disable collision
     void setCollisionEnabled(bool enabled);
+
+protected:
+    Transform transform;
+
+    // Normalized lerp along the shorter arc, close enough to slerp for the small steps between frames
+    static glm::quat nlerp(const glm::quat &from, const glm::quat &to, float alpha) {
+        glm::quat target = glm::dot(from, to) < 0.0f ? -to : to;
+        return glm::normalize(from + (target - from) * alpha);
+    }
+
+    Transform renderTransform;
 };
@@ -0,0 +1,139 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+
+namespace {
+
+// parallelFor chunks running on this thread; chunks can nest when a job calls parallelFor
+thread_local int jobDepth = 0;
+
+void runChunk(const std::function<void(size_t, size_t)> &fn, size_t begin, size_t end) {
+    jobDepth++;
+    fn(begin, end);
+    jobDepth--;
+}
+
+} // namespace
+
+bool JobSystem::isInJob() {
+    return jobDepth > 0;
+}
+
+unsigned JobSystem::defaultWorkerCount() {
+    unsigned hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+}
+
+JobSystem::JobSystem(unsigned workerCount) {
+    for (unsigned i = 0; i <= workerCount; ++i) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+    for (unsigned i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+void JobSystem::push(unsigned queueIndex, Job job) {
+    WorkQueue &queue = *queues[queueIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.jobs.push_back(std::move(job));
+}
+
+bool JobSystem::tryGetJob(unsigned queueIndex, Job &job) {
+    // Own queue first, newest job (still warm in cache)
+    {
+        WorkQueue &own = *queues[queueIndex];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.jobs.empty()) {
+            job = std::move(own.jobs.back());
+            own.jobs.pop_back();
+            return true;
+        }
+    }
+
+    // Steal the oldest job from someone else
+    size_t queueCount = queues.size();
+    for (size_t offset = 1; offset < queueCount; ++offset) {
+        WorkQueue &victim = *queues[(queueIndex + offset) % queueCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty()) {
+            job = std::move(victim.jobs.front());
+            victim.jobs.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::workerLoop(unsigned index) {
+    while (true) {
+        Job job;
+        if (tryGetJob(index, job)) {
+            job();
+            pendingJobs.fetch_sub(1, std::memory_order_acq_rel);
+            continue;
+        }
+
+        // Jobs are still running elsewhere and may be followed by more, stay close
+        if (pendingJobs.load(std::memory_order_acquire) > 0) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wakeCondition.wait(lock, [this] { return stopping || pendingJobs.load(std::memory_order_acquire) > 0; });
+        if (stopping) return;
+    }
+}
+
+void JobSystem::parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)> &fn) {
+    if (count == 0) return;
+    grainSize = std::max<size_t>(grainSize, 1);
+
+    // Not worth waking anyone up
+    if (workers.empty() || count <= grainSize) {
+        runChunk(fn, 0, count);
+        return;
+    }
+
+    size_t chunkCount = (count + grainSize - 1) / grainSize;
+    std::atomic<size_t> remaining{ chunkCount };
+
+    // Spread chunks over all queues so every worker starts with local work
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+        size_t begin = chunk * grainSize;
+        size_t end = std::min(begin + grainSize, count);
+        pendingJobs.fetch_add(1, std::memory_order_acq_rel);
+        push(static_cast<unsigned>(chunk % queues.size()), [&fn, &remaining, begin, end] {
+            runChunk(fn, begin, end);
+            remaining.fetch_sub(1, std::memory_order_acq_rel);
+            });
+    }
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+    }
+    wakeCondition.notify_all();
+
+    // Help out until our chunks are done
+    unsigned callerQueue = static_cast<unsigned>(queues.size() - 1);
+    while (remaining.load(std::memory_order_acquire) > 0) {
+        Job job;
+        if (tryGetJob(callerQueue, job)) {
+            job();
+            pendingJobs.fetch_sub(1, std::memory_order_acq_rel);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
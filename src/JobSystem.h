@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small work-stealing thread pool.
+// Every worker owns a queue: it pops its own jobs from the back and, when empty, steals from
+// the front of the other queues. parallelFor blocks, and the calling thread helps run jobs
+// while it waits, so a JobSystem with zero workers simply runs everything inline.
+class JobSystem {
+public:
+    // Workers used when no count is given: one per hardware thread, minus the calling thread
+    static unsigned defaultWorkerCount();
+
+    explicit JobSystem(unsigned workerCount = defaultWorkerCount());
+    ~JobSystem();
+
+    JobSystem(const JobSystem &) = delete;
+    JobSystem &operator=(const JobSystem &) = delete;
+
+    unsigned getWorkerCount() const { return static_cast<unsigned>(workers.size()); }
+
+    // Splits [0, count) into chunks of at most grainSize and calls fn(begin, end) for each,
+    // possibly on several threads. Returns once every chunk has finished.
+    void parallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)> &fn);
+
+    // True while the calling thread runs a parallelFor chunk of any JobSystem, so code that can
+    // start threads of its own (e.g. the TinyObj parser) stays single threaded inside a pool
+    static bool isInJob();
+
+private:
+    using Job = std::function<void()>;
+
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    std::vector<std::thread> workers;
+    // Queue i belongs to worker i; the last queue is used by threads outside the pool
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    std::atomic<int> pendingJobs{ 0 };
+    bool stopping = false;
+
+    void workerLoop(unsigned index);
+    void push(unsigned queueIndex, Job job);
+    // Pops from the given queue, or steals from another one. Returns false if all are empty.
+    bool tryGetJob(unsigned queueIndex, Job &job);
+};
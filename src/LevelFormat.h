@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+
+// Compiled level file (.lvlb), produced from the text description (.lvl) by LevelLoader::compile.
+// Layout: LevelHeader, then the model, object and link record arrays, then the string table.
+// Every record is plain data with 4-byte alignment, so the loader reads them straight out of
+// the memory-mapped file. Strings are offsets into the table and NUL terminated.
+// Values are stored in the byte order of the machine that compiled the level.
+
+constexpr char LEVEL_MAGIC[4] = { 'P', 'L', 'V', 'L' };
+constexpr uint32_t LEVEL_VERSION = 1;
+// Link target meaning "the level itself" (e.g. completing it)
+constexpr uint32_t LEVEL_TARGET_SELF = UINT32_MAX;
+
+enum class LevelObjectKind : uint8_t {
+    Object,
+    Button,
+    Flip
+};
+
+enum LevelObjectFlags : uint8_t {
+    LevelFlagPhysics = 1 << 0,
+    LevelFlagStatic = 1 << 1,
+    LevelFlagTeleportable = 1 << 2,
+    LevelFlagCanOpenPortal = 1 << 3,
+    LevelFlagHasPivot = 1 << 4
+};
+
+enum class LevelSignal : uint8_t {
+    Pressed,
+    Released
+};
+
+enum class LevelAction : uint8_t {
+    Flip,
+    Reset,
+    Complete
+};
+
+struct LevelHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t modelCount;
+    uint32_t objectCount;
+    uint32_t linkCount;
+    uint32_t modelsOffset;
+    uint32_t objectsOffset;
+    uint32_t linksOffset;
+    uint32_t stringsOffset;
+    uint32_t stringsSize;
+};
+
+struct LevelModelRecord {
+    uint32_t name;
+    uint32_t path;
+};
+
+struct LevelObjectRecord {
+    uint32_t name;
+    uint32_t model; // Index into the model records
+    LevelObjectKind kind;
+    uint8_t flags; // LevelObjectFlags
+    uint16_t padding;
+    uint32_t collisionMask;
+    float position[3];
+    float rotation[3];
+    float scale[3];
+    float pivot[3];
+    float mass;
+    float restitution;
+    float friction;
+};
+
+struct LevelLinkRecord {
+    uint32_t source; // Index into the object records
+    uint32_t target; // Index into the object records, or LEVEL_TARGET_SELF
+    LevelSignal signal;
+    LevelAction action;
+    uint16_t padding;
+};
@@ -0,0 +1,486 @@
+#include "LevelLoader.h"
+#include "JobSystem.h"
+#include "MappedFile.h"
+#include "Scene.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// Collects the records of a level while the text is parsed
+struct LevelBuilder {
+    std::vector<LevelModelRecord> models;
+    std::vector<LevelObjectRecord> objects;
+    std::vector<LevelLinkRecord> links;
+    std::string strings;
+
+    std::unordered_map<std::string, uint32_t> stringOffsets;
+    std::unordered_map<std::string, uint32_t> modelIndices;
+    std::unordered_map<std::string, uint32_t> objectIndices;
+
+    uint32_t addString(const std::string &value) {
+        auto it = stringOffsets.find(value);
+        if (it != stringOffsets.end()) return it->second;
+        uint32_t offset = static_cast<uint32_t>(strings.size());
+        strings.append(value);
+        strings.push_back('\0');
+        stringOffsets.emplace(value, offset);
+        return offset;
+    }
+};
+
+bool readVec3(std::istringstream &in, float out[3]) {
+    return static_cast<bool>(in >> out[0] >> out[1] >> out[2]);
+}
+
+// Parses "<name> <model> [options]" of an object line. Returns an error message, empty on success.
+std::string parseObject(std::istringstream &in, LevelObjectKind kind, LevelBuilder &level) {
+    std::string name, modelName;
+    if (!(in >> name >> modelName)) return "expected <name> <model>";
+    if (level.objectIndices.count(name)) return "object " + name + " already exists";
+    auto model = level.modelIndices.find(modelName);
+    if (model == level.modelIndices.end()) return "unknown model " + modelName;
+
+    LevelObjectRecord record = {};
+    record.name = level.addString(name);
+    record.model = model->second;
+    record.kind = kind;
+    record.flags = LevelFlagPhysics | LevelFlagStatic;
+    record.collisionMask = COLLISION_MASK_DEFAULT;
+    record.scale[0] = record.scale[1] = record.scale[2] = 1.0f;
+    record.mass = 1.0f;
+    record.restitution = 0.2f;
+    record.friction = 0.5f;
+
+    std::string option;
+    while (in >> option) {
+        bool ok = true;
+        if (option == "static") {
+            record.flags |= LevelFlagPhysics | LevelFlagStatic;
+        } else if (option == "dynamic") {
+            record.flags |= LevelFlagPhysics;
+            record.flags &= ~LevelFlagStatic;
+        } else if (option == "nophysics") {
+            record.flags &= ~(LevelFlagPhysics | LevelFlagStatic);
+        } else if (option == "portal") {
+            record.flags |= LevelFlagCanOpenPortal;
+        } else if (option == "teleportable") {
+            record.flags |= LevelFlagTeleportable;
+        } else if (option == "position") {
+            ok = readVec3(in, record.position);
+        } else if (option == "rotation") {
+            ok = readVec3(in, record.rotation);
+        } else if (option == "pivot") {
+            ok = readVec3(in, record.pivot);
+            record.flags |= LevelFlagHasPivot;
+        } else if (option == "scale") {
+            // One value for a uniform scale, three otherwise
+            ok = static_cast<bool>(in >> record.scale[0]);
+            float y, z;
+            std::streampos mark = in.tellg();
+            if (ok && in >> y >> z) {
+                record.scale[1] = y;
+                record.scale[2] = z;
+            } else if (ok) {
+                in.clear();
+                in.seekg(mark);
+                record.scale[1] = record.scale[2] = record.scale[0];
+            }
+        } else if (option == "mass") {
+            ok = static_cast<bool>(in >> record.mass);
+        } else if (option == "restitution") {
+            ok = static_cast<bool>(in >> record.restitution);
+        } else if (option == "friction") {
+            ok = static_cast<bool>(in >> record.friction);
+        } else if (option == "mask") {
+            ok = static_cast<bool>(in >> std::hex >> record.collisionMask >> std::dec);
+        } else {
+            return "unknown option " + option;
+        }
+        if (!ok) return "bad value for " + option;
+    }
+
+    level.objectIndices.emplace(name, static_cast<uint32_t>(level.objects.size()));
+    level.objects.push_back(record);
+    return "";
+}
+
+std::string parseLink(std::istringstream &in, LevelBuilder &level) {
+    std::string source, signal, target, action;
+    if (!(in >> source >> signal >> target >> action)) return "expected <source> <signal> <target> <action>";
+
+    LevelLinkRecord record = {};
+    auto sourceIt = level.objectIndices.find(source);
+    if (sourceIt == level.objectIndices.end()) return "unknown object " + source;
+    if (level.objects[sourceIt->second].kind != LevelObjectKind::Button) return source + " is not a button";
+    record.source = sourceIt->second;
+
+    if (signal == "pressed") {
+        record.signal = LevelSignal::Pressed;
+    } else if (signal == "released") {
+        record.signal = LevelSignal::Released;
+    } else {
+        return "unknown signal " + signal;
+    }
+
+    if (action == "complete") {
+        if (target != "level") return "complete needs the target level";
+        record.target = LEVEL_TARGET_SELF;
+        record.action = LevelAction::Complete;
+        level.links.push_back(record);
+        return "";
+    }
+
+    auto targetIt = level.objectIndices.find(target);
+    if (targetIt == level.objectIndices.end()) return "unknown object " + target;
+    if (level.objects[targetIt->second].kind != LevelObjectKind::Flip) return target + " is not a flip";
+    record.target = targetIt->second;
+    if (action == "flip") {
+        record.action = LevelAction::Flip;
+    } else if (action == "reset") {
+        record.action = LevelAction::Reset;
+    } else {
+        return "unknown action " + action;
+    }
+    level.links.push_back(record);
+    return "";
+}
+
+uint32_t alignTo4(size_t value) {
+    return static_cast<uint32_t>((value + 3) & ~size_t(3));
+}
+
+// Checks that count records of type T at offset lie inside the file
+template <typename T>
+bool recordsFit(const MappedFile &file, uint32_t offset, uint32_t count) {
+    return offset % alignof(T) == 0 && offset <= file.size() && count <= (file.size() - offset) / sizeof(T);
+}
+
+// Maps a compiled level and checks its format and ranges. Leaves file closed on failure.
+bool openCompiled(const std::string &binaryPath, MappedFile &file) {
+    if (!file.open(binaryPath)) {
+        return false;
+    }
+
+    // The file is trusted only after every range it describes has been checked
+    const LevelHeader *header = reinterpret_cast<const LevelHeader *>(file.data());
+    bool valid = file.size() >= sizeof(LevelHeader)
+        && std::memcmp(header->magic, LEVEL_MAGIC, sizeof(header->magic)) == 0
+        && header->version == LEVEL_VERSION
+        && recordsFit<LevelModelRecord>(file, header->modelsOffset, header->modelCount)
+        && recordsFit<LevelObjectRecord>(file, header->objectsOffset, header->objectCount)
+        && recordsFit<LevelLinkRecord>(file, header->linksOffset, header->linkCount)
+        && recordsFit<char>(file, header->stringsOffset, header->stringsSize)
+        && (header->stringsSize == 0 || file.data()[header->stringsOffset + header->stringsSize - 1] == '\0');
+    if (!valid) {
+        file.close();
+    }
+    return valid;
+}
+
+} // namespace
+
+std::string LevelLoader::binaryPathFor(const std::string &textPath) {
+    std::filesystem::path path(textPath);
+    path.replace_extension(".lvlb");
+    return path.string();
+}
+
+bool LevelLoader::compile(const std::string &textPath, const std::string &binaryPath) {
+    std::ifstream file(textPath);
+    if (!file.is_open()) {
+        std::cout << "Failed to open level file: " << textPath << std::endl;
+        return false;
+    }
+
+    LevelBuilder level;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) line.resize(comment);
+
+        std::istringstream in(line);
+        std::string keyword;
+        if (!(in >> keyword)) continue;
+
+        std::string error;
+        if (keyword == "model") {
+            std::string name, path;
+            if (!(in >> name >> path)) {
+                error = "expected <name> <path>";
+            } else if (level.modelIndices.count(name)) {
+                error = "model " + name + " already exists";
+            } else {
+                level.modelIndices.emplace(name, static_cast<uint32_t>(level.models.size()));
+                level.models.push_back({ level.addString(name), level.addString(path) });
+            }
+        } else if (keyword == "object") {
+            error = parseObject(in, LevelObjectKind::Object, level);
+        } else if (keyword == "button") {
+            error = parseObject(in, LevelObjectKind::Button, level);
+        } else if (keyword == "flip") {
+            error = parseObject(in, LevelObjectKind::Flip, level);
+        } else if (keyword == "link") {
+            error = parseLink(in, level);
+        } else {
+            error = "unknown entry " + keyword;
+        }
+
+        if (!error.empty()) {
+            std::cout << "ERROR::LEVEL::" << textPath << ":" << lineNumber << ": " << error << std::endl;
+            return false;
+        }
+    }
+
+    LevelHeader header = {};
+    std::memcpy(header.magic, LEVEL_MAGIC, sizeof(header.magic));
+    header.version = LEVEL_VERSION;
+    header.modelCount = static_cast<uint32_t>(level.models.size());
+    header.objectCount = static_cast<uint32_t>(level.objects.size());
+    header.linkCount = static_cast<uint32_t>(level.links.size());
+    header.modelsOffset = alignTo4(sizeof(LevelHeader));
+    header.objectsOffset = alignTo4(header.modelsOffset + level.models.size() * sizeof(LevelModelRecord));
+    header.linksOffset = alignTo4(header.objectsOffset + level.objects.size() * sizeof(LevelObjectRecord));
+    header.stringsOffset = alignTo4(header.linksOffset + level.links.size() * sizeof(LevelLinkRecord));
+    header.stringsSize = static_cast<uint32_t>(level.strings.size());
+
+    // Assemble the whole image first so the file is written with one call
+    std::vector<char> image(header.stringsOffset + level.strings.size(), 0);
+    std::memcpy(image.data(), &header, sizeof(header));
+    if (!level.models.empty()) std::memcpy(image.data() + header.modelsOffset, level.models.data(), level.models.size() * sizeof(LevelModelRecord));
+    if (!level.objects.empty()) std::memcpy(image.data() + header.objectsOffset, level.objects.data(), level.objects.size() * sizeof(LevelObjectRecord));
+    if (!level.links.empty()) std::memcpy(image.data() + header.linksOffset, level.links.data(), level.links.size() * sizeof(LevelLinkRecord));
+    if (!level.strings.empty()) std::memcpy(image.data() + header.stringsOffset, level.strings.data(), level.strings.size());
+
+    // Written aside and renamed into place, so a reader never maps a half-written file
+    std::string tempPath = binaryPath + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open() || !out.write(image.data(), static_cast<std::streamsize>(image.size()))) {
+            std::cout << "Failed to write compiled level: " << tempPath << std::endl;
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(tempPath, binaryPath, error);
+    if (error) {
+        std::cout << "Failed to write compiled level: " << binaryPath << " (" << error.message() << ")" << std::endl;
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+    return true;
+}
+
+bool LevelLoader::compileIfStale(const std::string &textPath, const std::string &binaryPath) {
+    std::error_code error;
+    bool stale = !std::filesystem::exists(binaryPath, error);
+    if (!stale && std::filesystem::exists(textPath, error)) {
+        // A time that cannot be read counts as stale
+        auto textTime = std::filesystem::last_write_time(textPath, error);
+        auto binaryTime = error ? textTime : std::filesystem::last_write_time(binaryPath, error);
+        stale = error || textTime > binaryTime;
+    }
+    return !stale || compile(textPath, binaryPath);
+}
+
+LevelLoader::ModelLookup LevelLoader::snapshotModels(const Scene &scene) {
+    ModelLookup models;
+    models.reserve(scene.modelResources.size());
+    for (size_t i = 0; i < scene.modelResources.size(); ++i) {
+        models.emplace(scene.modelResources.nameOf(scene.modelResources.handleAt(i)), scene.modelResources.values()[i].get());
+    }
+    return models;
+}
+
+bool LevelLoader::load(Scene &scene, const std::string &textPath) {
+    std::unique_ptr<PreparedLevel> level = prepare(textPath, snapshotModels(scene));
+    if (!level) return false;
+    for (auto &model : level->models) {
+        model.model->upload();
+    }
+    commit(scene, *level);
+    return true;
+}
+
+std::unique_ptr<PreparedLevel> LevelLoader::prepare(const std::string &textPath, const ModelLookup &existingModels, JobSystem *jobs) {
+    std::string binaryPath = binaryPathFor(textPath);
+    if (!compileIfStale(textPath, binaryPath)) {
+        return nullptr;
+    }
+
+    MappedFile file;
+    if (!openCompiled(binaryPath, file)) {
+        // Newer than its text but unusable: left by an older build or cut short. Compile once more.
+        std::cout << "ERROR::LEVEL:: " << binaryPath << " is not a compiled level of version " << LEVEL_VERSION << ", recompiling" << std::endl;
+        if (!compile(textPath, binaryPath) || !openCompiled(binaryPath, file)) {
+            std::cout << "Failed to open compiled level: " << binaryPath << std::endl;
+            return nullptr;
+        }
+    }
+
+    const LevelHeader *header = reinterpret_cast<const LevelHeader *>(file.data());
+    const uint8_t *base = file.data();
+    const auto *models = reinterpret_cast<const LevelModelRecord *>(base + header->modelsOffset);
+    const auto *objects = reinterpret_cast<const LevelObjectRecord *>(base + header->objectsOffset);
+    const auto *links = reinterpret_cast<const LevelLinkRecord *>(base + header->linksOffset);
+    const char *strings = reinterpret_cast<const char *>(base + header->stringsOffset);
+    auto stringAt = [&](uint32_t offset) -> const char * {
+        return offset < header->stringsSize ? strings + offset : "";
+        };
+
+    auto level = std::make_unique<PreparedLevel>();
+
+    // Models already loaded (e.g. the portal cube) are shared, the others are parsed here
+    std::vector<Model *> levelModels(header->modelCount, nullptr);
+    std::vector<uint32_t> newModelRecords;
+    for (uint32_t i = 0; i < header->modelCount; ++i) {
+        auto existing = existingModels.find(stringAt(models[i].name));
+        if (existing != existingModels.end()) {
+            levelModels[i] = existing->second;
+        } else {
+            newModelRecords.push_back(i);
+        }
+    }
+    level->models.resize(newModelRecords.size());
+    auto parseModels = [&](size_t begin, size_t end) {
+        for (size_t k = begin; k < end; ++k) {
+            const LevelModelRecord &record = models[newModelRecords[k]];
+            level->models[k].name = stringAt(record.name);
+            level->models[k].model = std::make_unique<Model>(stringAt(record.path), ModelUpload::Deferred);
+        }
+        };
+    if (jobs) {
+        jobs->parallelFor(newModelRecords.size(), 1, parseModels);
+    } else {
+        parseModels(0, newModelRecords.size());
+    }
+    for (size_t k = 0; k < newModelRecords.size(); ++k) {
+        levelModels[newModelRecords[k]] = level->models[k].model.get();
+    }
+
+    level->objects.reserve(header->objectCount);
+    for (uint32_t i = 0; i < header->objectCount; ++i) {
+        const LevelObjectRecord &record = objects[i];
+        if (record.model >= header->modelCount) {
+            std::cout << "ERROR::LEVEL:: object " << stringAt(record.name) << " references a missing model" << std::endl;
+            return nullptr;
+        }
+        Model *model = levelModels[record.model];
+        glm::vec3 position(record.position[0], record.position[1], record.position[2]);
+        glm::vec3 rotation(record.rotation[0], record.rotation[1], record.rotation[2]);
+        glm::vec3 scale(record.scale[0], record.scale[1], record.scale[2]);
+
+        PreparedLevel::Object prepared;
+        prepared.name = stringAt(record.name);
+        prepared.kind = record.kind;
+        switch (record.kind) {
+        case LevelObjectKind::Button: {
+            auto button = std::make_unique<Button>(model, position, rotation, scale);
+            prepared.trigger = button->createTrigger();
+            prepared.object = std::move(button);
+            break;
+        }
+        case LevelObjectKind::Flip: {
+            auto flip = std::make_unique<Flip>(model, position, rotation, scale);
+            if (record.flags & LevelFlagHasPivot) {
+                flip->setPivot(glm::vec3(record.pivot[0], record.pivot[1], record.pivot[2]));
+            }
+            flip->setPosition(position);
+            prepared.object = std::move(flip);
+            break;
+        }
+        default:
+            prepared.object = std::make_unique<GameObject>(model, position, rotation, scale);
+            break;
+        }
+
+        GameObject *obj = prepared.object.get();
+        obj->isTeleportable = (record.flags & LevelFlagTeleportable) != 0;
+        obj->canOpenPortal = (record.flags & LevelFlagCanOpenPortal) != 0;
+        if (record.flags & LevelFlagPhysics) {
+            // Rigid body and collider are built here, commit() only registers them
+            Scene::createPhysics(obj, (record.flags & LevelFlagStatic) != 0, record.collisionMask,
+                record.mass, record.restitution, record.friction);
+        }
+        level->objects.push_back(std::move(prepared));
+    }
+
+    level->links.reserve(header->linkCount);
+    for (uint32_t i = 0; i < header->linkCount; ++i) {
+        if (links[i].source >= header->objectCount || level->objects[links[i].source].kind != LevelObjectKind::Button) {
+            std::cout << "ERROR::LEVEL:: link " << i << " has no button as its source" << std::endl;
+            continue;
+        }
+        if (links[i].action != LevelAction::Complete && links[i].target >= header->objectCount) {
+            std::cout << "ERROR::LEVEL:: link " << i << " has no target" << std::endl;
+            continue;
+        }
+        level->links.push_back(links[i]);
+    }
+    return level;
+}
+
+void LevelLoader::commit(Scene &scene, PreparedLevel &level) {
+    scene.modelResources.reserve(scene.modelResources.size() + level.models.size());
+    scene.objects.reserve(scene.objects.size() + level.objects.size());
+
+    for (auto &model : level.models) {
+        // A model of that name may have been loaded since prepare() took its snapshot; the
+        // objects point at this one, so it has to stay alive under another name
+        std::string name = model.name;
+        for (int suffix = 1; scene.modelResources.contains(name); ++suffix) {
+            name = model.name + "#" + std::to_string(suffix);
+        }
+        scene.addModelResource(name, std::move(model.model));
+    }
+    level.models.clear();
+
+    std::vector<EntityHandle> handles(level.objects.size());
+    for (size_t i = 0; i < level.objects.size(); ++i) {
+        PreparedLevel::Object &prepared = level.objects[i];
+        GameObject *obj = prepared.object.get();
+        // The scene destroys an object whose name is taken, so nothing may point at it before it is in
+        handles[i] = scene.addObject(prepared.name, std::move(prepared.object));
+        if (!handles[i].isValid()) continue;
+        scene.levelObjects.push_back(handles[i]);
+
+        if (prepared.trigger) {
+            EntityHandle trigger = scene.addTrigger(prepared.name + "_trigger", std::move(prepared.trigger));
+            if (trigger.isValid()) scene.levelTriggers.push_back(trigger);
+        }
+        if (obj->rigidBody) {
+            scene.physicsSystem->addObject(obj, obj->rigidBody.get(), obj->collider.get());
+        }
+        if (prepared.kind == LevelObjectKind::Flip) {
+            // A wall that starts moving takes any portal on it down
+            Flip *flip = static_cast<Flip *>(obj);
+            flip->rotationStarted.connect([&scene, flip] {
+                scene.closePortalsOn(flip);
+                });
+        }
+    }
+
+    for (const LevelLinkRecord &record : level.links) {
+        Button *source = dynamic_cast<Button *>(scene.objects.get(handles[record.source]));
+        if (!source) continue;
+        Signal<> &signal = record.signal == LevelSignal::Pressed ? source->pressed : source->released;
+
+        if (record.action == LevelAction::Complete) {
+            signal.connect([&scene] {
+                scene.levelCompleted.emit();
+                });
+        } else {
+            scene.link(signal, handles[record.target], record.action == LevelAction::Flip ? &Flip::flip : &Flip::reset);
+        }
+    }
+    level.objects.clear();
+    level.links.clear();
+}
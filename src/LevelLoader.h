@@ -0,0 +1,73 @@
+#pragma once
+
+#include "GameObject.h"
+#include "LevelFormat.h"
+#include "Model.h"
+#include "Trigger.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct Scene;
+class JobSystem;
+
+// A level read and built away from the GL thread. Its new models still have to be uploaded
+// (Model::uploadStep) before LevelLoader::commit hands everything to a scene.
+struct PreparedLevel {
+    struct NewModel {
+        std::string name;
+        std::unique_ptr<Model> model; // Loaded with ModelUpload::Deferred
+    };
+
+    struct Object {
+        std::string name;
+        LevelObjectKind kind = LevelObjectKind::Object;
+        std::unique_ptr<GameObject> object; // Rigid body and collider already built
+        std::unique_ptr<Trigger> trigger; // Buttons only
+    };
+
+    std::vector<NewModel> models;
+    std::vector<Object> objects;
+    std::vector<LevelLinkRecord> links; // Checked against objects
+};
+
+// Levels are authored as text (.lvl) and loaded from a compiled binary (.lvlb, see LevelFormat.h)
+// that is memory-mapped and read record by record, without any parsing at load time.
+//
+// Text format, one entry per line, '#' starts a comment:
+//   model <name> <path>
+//   object|button|flip <name> <model> [options]
+//   link <source> pressed|released <target>|level flip|reset|complete
+// Object options: static (default) | dynamic | nophysics, position x y z, rotation x y z,
+// scale s | scale x y z, pivot x y z, portal (can open portals), teleportable, mass m,
+// restitution r, friction f, mask <hex collision mask>.
+// Buttons get their trigger from Button::createTrigger, named <name>_trigger.
+class LevelLoader {
+public:
+    // Compiles the text form into the binary form. Prints the offending line and returns false on error.
+    static bool compile(const std::string &textPath, const std::string &binaryPath);
+
+    // Name -> model of everything a scene has loaded, for prepare() to share instead of reloading
+    using ModelLookup = std::unordered_map<std::string, Model *>;
+    static ModelLookup snapshotModels(const Scene &scene);
+
+    // Loads the level described by textPath on the calling thread: prepare, upload, commit.
+    static bool load(Scene &scene, const std::string &textPath);
+
+    // Reads the level and parses its models (in parallel when jobs is given) without touching
+    // GL or any scene, so it can run on a loader thread. The compiled file next to textPath is
+    // rebuilt first when it is missing or older than the text. Returns null on error.
+    static std::unique_ptr<PreparedLevel> prepare(const std::string &textPath, const ModelLookup &existingModels, JobSystem *jobs = nullptr);
+
+    // Moves a prepared level into the scene: models, objects, physics, triggers and links.
+    // Main thread only, after every model of the level has been uploaded.
+    static void commit(Scene &scene, PreparedLevel &level);
+
+    // <path without extension>.lvlb
+    static std::string binaryPathFor(const std::string &textPath);
+
+private:
+    static bool compileIfStale(const std::string &textPath, const std::string &binaryPath);
+};
@@ -0,0 +1,68 @@
+#include "LevelStreamer.h"
+#include "JobSystem.h"
+#include "Scene.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+// Parsing is I/O and allocation heavy, a couple of threads next to the loader is plenty
+constexpr unsigned LOADER_WORKERS = 2;
+
+LevelStreamer::LevelStreamer(Scene &scene)
+    : scene(scene), jobs(std::make_unique<JobSystem>(std::min(LOADER_WORKERS, JobSystem::defaultWorkerCount()))) {
+}
+
+LevelStreamer::~LevelStreamer() {
+    if (loader.joinable()) {
+        loader.join();
+    }
+}
+
+bool LevelStreamer::request(const std::string &textPath) {
+    if (state != State::Idle) return false;
+
+    // The snapshot is taken here: the loader thread must not look at the scene
+    LevelLoader::ModelLookup existingModels = LevelLoader::snapshotModels(scene);
+    path = textPath;
+    prepared = false;
+    state = State::Preparing;
+    loader = std::thread([this, existingModels = std::move(existingModels)] {
+        level = LevelLoader::prepare(path, existingModels, jobs.get());
+        prepared.store(true, std::memory_order_release);
+        });
+    return true;
+}
+
+bool LevelStreamer::update(double budgetSeconds) {
+    if (state == State::Preparing) {
+        if (!prepared.load(std::memory_order_acquire)) return false;
+        loader.join();
+        if (!level) {
+            std::cout << "Failed to stream level: " << path << std::endl;
+            state = State::Idle;
+            return false;
+        }
+        nextModel = 0;
+        state = State::Uploading;
+    }
+    if (state != State::Uploading) return false;
+
+    // At least one step per frame so a tiny budget still makes progress
+    auto start = std::chrono::steady_clock::now();
+    while (nextModel < level->models.size()) {
+        if (level->models[nextModel].model->uploadStep()) {
+            nextModel++;
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed.count() >= budgetSeconds) break;
+    }
+    if (nextModel < level->models.size()) return false;
+
+    scene.unloadLevel();
+    LevelLoader::commit(scene, *level);
+    scene.unloadUnusedModels();
+    level.reset();
+    state = State::Idle;
+    return true;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "LevelLoader.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+struct Scene;
+class JobSystem;
+
+// Loads a level in the background while the current one keeps running, then swaps them.
+// A loader thread reads the level, parses its models and builds the physics bodies
+// (LevelLoader::prepare); update() uploads the new models a slice at a time on the GL thread
+// and, once everything is on the GPU, unloads the old level, commits the new one and drops
+// the models nothing uses any more.
+class LevelStreamer {
+public:
+    explicit LevelStreamer(Scene &scene);
+    ~LevelStreamer();
+
+    LevelStreamer(const LevelStreamer &) = delete;
+    LevelStreamer &operator=(const LevelStreamer &) = delete;
+
+    // Starts loading textPath. Ignored (returns false) while another level is loading.
+    bool request(const std::string &textPath);
+
+    // Main thread, once per frame. Spends at most budgetSeconds uploading; returns true on the
+    // frame the new level was swapped in.
+    bool update(double budgetSeconds);
+
+    bool isLoading() const { return state != State::Idle; }
+
+private:
+    enum class State {
+        Idle,
+        Preparing, // Loader thread running
+        Uploading,
+    };
+
+    Scene &scene;
+    std::unique_ptr<JobSystem> jobs; // Separate from the physics pool, which runs every frame
+    std::thread loader;
+    std::atomic<bool> prepared{ false };
+    State state = State::Idle;
+
+    std::string path;
+    std::unique_ptr<PreparedLevel> level;
+    size_t nextModel = 0;
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-only memory mapping of a whole file. The contents are paged in by the OS on first
+// access instead of being copied through a stream. Move-only; unmaps on destruction.
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string &path) { open(path); }
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    // Returns false if the file can not be opened or mapped. An empty file opens with size 0.
+    bool open(const std::string &path);
+    void close();
+
+    bool isOpen() const { return opened; }
+    const uint8_t *data() const { return bytes; }
+    size_t size() const { return length; }
+
+private:
+    const uint8_t *bytes = nullptr;
+    size_t length = 0;
+    bool opened = false;
+#ifdef _WIN32
+    void *fileHandle = nullptr;
+    void *mappingHandle = nullptr;
+#endif
+
+    void moveFrom(MappedFile &other);
+};
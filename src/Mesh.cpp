@@ -9,8 +9,24 @@ Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std:
     this->diffuseColor = diffuse;
     this->specularColor = specular;
     this->shininess = shininess;
+    this->indexCount = static_cast<GLsizei>(this->indices.size());
+    this->indexType = GL_UNSIGNED_INT;
 
-    setupMesh();
+    setupMesh(this->vertices.data(), this->vertices.size(), this->indices.data(), this->indices.size() * sizeof(unsigned int));
+}
+
+Mesh::Mesh(const Vertex *vertexData, size_t vertexCount, const void *indexData, size_t indexCount, GLenum indexType, std::vector<Texture> textures,
+    glm::vec3 ambient, glm::vec3 diffuse, glm::vec3 specular, float shininess) {
+    this->textures = textures;
+    this->ambientColor = ambient;
+    this->diffuseColor = diffuse;
+    this->specularColor = specular;
+    this->shininess = shininess;
+    this->indexCount = static_cast<GLsizei>(indexCount);
+    this->indexType = indexType;
+
+    size_t indexSize = indexType == GL_UNSIGNED_SHORT ? sizeof(unsigned short) : sizeof(unsigned int);
+    setupMesh(vertexData, vertexCount, indexData, indexCount * indexSize);
 }
 
 void Mesh::Draw(Shader &shader) {
@@ -51,13 +67,21 @@ void Mesh::Draw(Shader &shader) {
 
     // draw mesh
     glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
+    glDrawElements(GL_TRIANGLES, indexCount, indexType, 0);
     glBindVertexArray(0);
 
     glActiveTexture(GL_TEXTURE0);
 }
 
-void Mesh::setupMesh() {
+void Mesh::release() {
+    if (VAO == 0) return;
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
+    VAO = VBO = EBO = 0;
+}
+
+void Mesh::setupMesh(const Vertex *vertexData, size_t vertexCount, const void *indexData, size_t indexBytes) {
     // create buffers/arrays
     glGenVertexArrays(1, &VAO);
     glGenBuffers(1, &VBO);
@@ -65,10 +89,10 @@ void Mesh::setupMesh() {
 
     glBindVertexArray(VAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(Vertex), vertexData, GL_STATIC_DRAW);
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexBytes, indexData, GL_STATIC_DRAW);
 
     // set the vertex attribute pointers
     // vertex Positions
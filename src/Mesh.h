@@ -31,14 +31,23 @@ public:
     // constructor
     Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture> textures,
         glm::vec3 ambient = glm::vec3(1.0f), glm::vec3 diffuse = glm::vec3(1.0f), glm::vec3 specular = glm::vec3(0.5f), float shininess = 32.0f);
+    // Uploads straight from memory the mesh does not keep (e.g. a mapped cooked file); vertices and
+    // indices stay empty. indexType is GL_UNSIGNED_SHORT or GL_UNSIGNED_INT.
+    Mesh(const Vertex *vertexData, size_t vertexCount, const void *indexData, size_t indexCount, GLenum indexType, std::vector<Texture> textures,
+        glm::vec3 ambient = glm::vec3(1.0f), glm::vec3 diffuse = glm::vec3(1.0f), glm::vec3 specular = glm::vec3(0.5f), float shininess = 32.0f);
 
     // render the mesh
     void Draw(Shader &shader);
 
+    // Deletes the GL buffers. Meshes are copied around by value, so only the owning Model calls this.
+    void release();
+
 private:
     // render data 
     unsigned int VBO, EBO;
+    GLsizei indexCount;
+    GLenum indexType;
 
     // initializes all the buffer objects/arrays
-    void setupMesh();
+    void setupMesh(const Vertex *vertexData, size_t vertexCount, const void *indexData, size_t indexBytes);
 };
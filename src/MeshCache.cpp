@@ -0,0 +1,261 @@
+#include "MeshCache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+static_assert(sizeof(Vertex) == 8 * sizeof(float), "cooked vertices are written as raw Vertex structs");
+
+uint32_t alignTo4(size_t value) {
+    return static_cast<uint32_t>((value + 3) & ~size_t(3));
+}
+
+// Checks that count records of type T at offset lie inside the file
+template <typename T>
+bool recordsFit(const MappedFile &file, uint32_t offset, uint32_t count) {
+    return offset % alignof(T) == 0 && offset <= file.size() && count <= (file.size() - offset) / sizeof(T);
+}
+
+// Every index of a submesh must stay inside its own vertices
+template <typename Index>
+bool indicesInRange(const uint8_t *data, uint32_t count, uint32_t vertexCount) {
+    const Index *indices = reinterpret_cast<const Index *>(data);
+    for (uint32_t i = 0; i < count; ++i) {
+        if (indices[i] >= vertexCount) return false;
+    }
+    return true;
+}
+
+// Word-at-a-time multiplicative hash. Not cryptographic, it only has to notice edited sources.
+uint64_t hashBytes(const uint8_t *data, size_t size, uint64_t hash) {
+    constexpr uint64_t MULTIPLIER = 0x9E3779B97F4A7C15ull;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * MULTIPLIER;
+        hash ^= hash >> 29;
+    }
+    uint64_t tail = 0;
+    if (i < size) std::memcpy(&tail, data + i, size - i);
+    hash = (hash ^ tail ^ size) * MULTIPLIER;
+    return hash ^ (hash >> 32);
+}
+
+uint64_t hashFile(const std::string &path, uint64_t hash) {
+    MappedFile file;
+    if (!file.open(path)) {
+        return hashBytes(nullptr, 0, hash);
+    }
+    return hashBytes(file.data(), file.size(), hash);
+}
+
+std::string directoryOf(const std::string &path) {
+    return path.substr(0, path.find_last_of('/'));
+}
+
+} // namespace
+
+std::atomic<bool> MeshCache::enabled(true);
+
+std::string MeshCache::cookedPathFor(const std::string &objPath) {
+    std::filesystem::path path(objPath);
+    path.replace_extension(".meshb");
+    return path.string();
+}
+
+uint64_t MeshCache::hashSources(const std::string &objPath, const std::vector<std::string> &materialLibraries) {
+    uint64_t hash = hashFile(objPath, MESH_VERSION);
+    std::string directory = directoryOf(objPath);
+    for (const std::string &library : materialLibraries) {
+        hash = hashFile(directory + "/" + library, hash);
+    }
+    return hash;
+}
+
+bool MeshCache::open(const std::string &objPath, MappedFile &file) {
+    std::string cookedPath = cookedPathFor(objPath);
+    std::error_code error;
+    if (!std::filesystem::exists(cookedPath, error) || !file.open(cookedPath)) {
+        return false;
+    }
+
+    auto reject = [&] {
+        std::cout << "ERROR::MESH:: " << cookedPath << " is not a cooked mesh of version " << MESH_VERSION << ", re-cooking" << std::endl;
+        file.close();
+        return false;
+        };
+
+    // The file is trusted only after every range it describes has been checked. No offset is
+    // followed before the header itself has passed.
+    const uint8_t *base = file.data();
+    const MeshHeader *header = reinterpret_cast<const MeshHeader *>(base);
+    bool valid = file.size() >= sizeof(MeshHeader)
+        && std::memcmp(header->magic, MESH_MAGIC, sizeof(header->magic)) == 0
+        && header->version == MESH_VERSION
+        && header->vertexSize == sizeof(Vertex)
+        && recordsFit<MeshSubmeshRecord>(file, header->submeshesOffset, header->submeshCount)
+        && recordsFit<MeshSourceRecord>(file, header->sourcesOffset, header->sourceCount)
+        && recordsFit<Vertex>(file, header->verticesOffset, header->vertexCount)
+        && recordsFit<char>(file, header->stringsOffset, header->stringsSize)
+        && (header->stringsSize == 0 || base[header->stringsOffset + header->stringsSize - 1] == '\0');
+    if (!valid) {
+        return reject();
+    }
+
+    const auto *submeshes = reinterpret_cast<const MeshSubmeshRecord *>(base + header->submeshesOffset);
+    for (uint32_t i = 0; valid && i < header->submeshCount; ++i) {
+        const MeshSubmeshRecord &submesh = submeshes[i];
+        valid = submesh.diffuseMap < header->stringsSize
+            && submesh.firstVertex <= header->vertexCount
+            && submesh.vertexCount <= header->vertexCount - submesh.firstVertex;
+        if (valid && submesh.indexSize == 2) {
+            valid = recordsFit<uint16_t>(file, submesh.indicesOffset, submesh.indexCount)
+                && indicesInRange<uint16_t>(base + submesh.indicesOffset, submesh.indexCount, submesh.vertexCount);
+        } else if (valid) {
+            valid = submesh.indexSize == 4
+                && recordsFit<uint32_t>(file, submesh.indicesOffset, submesh.indexCount)
+                && indicesInRange<uint32_t>(base + submesh.indicesOffset, submesh.indexCount, submesh.vertexCount);
+        }
+    }
+
+    std::vector<std::string> materialLibraries;
+    const auto *sources = reinterpret_cast<const MeshSourceRecord *>(base + header->sourcesOffset);
+    const char *strings = reinterpret_cast<const char *>(base + header->stringsOffset);
+    for (uint32_t i = 0; valid && i < header->sourceCount; ++i) {
+        valid = sources[i].path < header->stringsSize;
+        if (valid) materialLibraries.emplace_back(strings + sources[i].path);
+    }
+    if (!valid) {
+        return reject();
+    }
+
+    uint64_t hash = hashSources(objPath, materialLibraries);
+    if (static_cast<uint32_t>(hash) != header->sourceHash[0] || static_cast<uint32_t>(hash >> 32) != header->sourceHash[1]) {
+        std::cout << "Cooked mesh " << cookedPath << " is out of date, re-cooking" << std::endl;
+        file.close();
+        return false;
+    }
+    return true;
+}
+
+bool MeshCache::cook(const std::string &objPath, const std::vector<std::string> &materialLibraries,
+    const glm::vec3 &minBound, const glm::vec3 &maxBound, const std::vector<MeshData> &meshes) {
+    std::string strings;
+    auto addString = [&](const std::string &value) {
+        uint32_t offset = static_cast<uint32_t>(strings.size());
+        strings.append(value);
+        strings.push_back('\0');
+        return offset;
+        };
+
+    std::vector<MeshSourceRecord> sources;
+    for (const std::string &library : materialLibraries) {
+        sources.push_back({ addString(library) });
+    }
+
+    uint64_t hash = hashSources(objPath, materialLibraries);
+    MeshHeader header = {};
+    std::memcpy(header.magic, MESH_MAGIC, sizeof(header.magic));
+    header.version = MESH_VERSION;
+    header.vertexSize = sizeof(Vertex);
+    header.sourceHash[0] = static_cast<uint32_t>(hash);
+    header.sourceHash[1] = static_cast<uint32_t>(hash >> 32);
+    header.submeshCount = static_cast<uint32_t>(meshes.size());
+    header.sourceCount = static_cast<uint32_t>(sources.size());
+    for (int axis = 0; axis < 3; ++axis) {
+        header.minBound[axis] = minBound[axis];
+        header.maxBound[axis] = maxBound[axis];
+    }
+
+    // Lay out the records, then the vertices, then one index block per submesh
+    std::vector<MeshSubmeshRecord> submeshes(meshes.size());
+    size_t vertexCount = 0;
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        const MeshData &mesh = meshes[i];
+        MeshSubmeshRecord &submesh = submeshes[i];
+        submesh.diffuseMap = addString(mesh.diffuseMap);
+        for (int axis = 0; axis < 3; ++axis) {
+            submesh.ambientColor[axis] = mesh.ambientColor[axis];
+            submesh.diffuseColor[axis] = mesh.diffuseColor[axis];
+            submesh.specularColor[axis] = mesh.specularColor[axis];
+        }
+        submesh.shininess = mesh.shininess;
+        submesh.firstVertex = static_cast<uint32_t>(vertexCount);
+        submesh.vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+        submesh.indexCount = static_cast<uint32_t>(mesh.indices.size());
+        submesh.indexSize = mesh.vertices.size() <= 0x10000 ? 2 : 4;
+        vertexCount += mesh.vertices.size();
+    }
+    header.vertexCount = static_cast<uint32_t>(vertexCount);
+    header.submeshesOffset = alignTo4(sizeof(MeshHeader));
+    header.sourcesOffset = alignTo4(header.submeshesOffset + submeshes.size() * sizeof(MeshSubmeshRecord));
+    header.verticesOffset = alignTo4(header.sourcesOffset + sources.size() * sizeof(MeshSourceRecord));
+    size_t end = header.verticesOffset + vertexCount * sizeof(Vertex);
+    for (MeshSubmeshRecord &submesh : submeshes) {
+        submesh.indicesOffset = alignTo4(end);
+        end = submesh.indicesOffset + size_t(submesh.indexCount) * submesh.indexSize;
+    }
+    header.stringsOffset = alignTo4(end);
+    header.stringsSize = static_cast<uint32_t>(strings.size());
+    size_t imageSize = size_t(header.stringsOffset) + strings.size();
+    if (end > UINT32_MAX || imageSize > UINT32_MAX) {
+        std::cout << "Model too large to cook: " << objPath << std::endl;
+        return false;
+    }
+
+    // Assemble the whole image first so the file is written with one call
+    std::vector<char> image(imageSize, 0);
+    std::memcpy(image.data(), &header, sizeof(header));
+    if (!submeshes.empty()) std::memcpy(image.data() + header.submeshesOffset, submeshes.data(), submeshes.size() * sizeof(MeshSubmeshRecord));
+    if (!sources.empty()) std::memcpy(image.data() + header.sourcesOffset, sources.data(), sources.size() * sizeof(MeshSourceRecord));
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        const MeshData &mesh = meshes[i];
+        const MeshSubmeshRecord &submesh = submeshes[i];
+        if (!mesh.vertices.empty()) {
+            std::memcpy(image.data() + header.verticesOffset + size_t(submesh.firstVertex) * sizeof(Vertex), mesh.vertices.data(), mesh.vertices.size() * sizeof(Vertex));
+        }
+        char *indices = image.data() + submesh.indicesOffset;
+        if (submesh.indexSize == 2) {
+            for (size_t k = 0; k < mesh.indices.size(); ++k) {
+                uint16_t index = static_cast<uint16_t>(mesh.indices[k]);
+                std::memcpy(indices + k * sizeof(index), &index, sizeof(index));
+            }
+        } else if (!mesh.indices.empty()) {
+            std::memcpy(indices, mesh.indices.data(), mesh.indices.size() * sizeof(unsigned int));
+        }
+    }
+    if (!strings.empty()) std::memcpy(image.data() + header.stringsOffset, strings.data(), strings.size());
+
+    // Written aside and renamed into place, so a reader never maps a half-written file
+    std::string cookedPath = cookedPathFor(objPath);
+    std::string tempPath = cookedPath + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open() || !out.write(image.data(), static_cast<std::streamsize>(image.size()))) {
+            std::cout << "Failed to write cooked mesh: " << tempPath << std::endl;
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(tempPath, cookedPath, error);
+    if (error) {
+        std::cout << "Failed to write cooked mesh: " << cookedPath << " (" << error.message() << ")" << std::endl;
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+    return true;
+}
+
+bool MeshCache::cookIfStale(const std::string &objPath) {
+    MappedFile file;
+    if (open(objPath, file)) {
+        return true;
+    }
+    // Parsing a model without a valid cooked file cooks it
+    Model model(objPath, ModelUpload::Deferred);
+    return open(objPath, file);
+}
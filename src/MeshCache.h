@@ -0,0 +1,43 @@
+#pragma once
+
+#include "MappedFile.h"
+#include "MeshFormat.h"
+#include "Model.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Cooked copies of parsed models (see MeshFormat.h). A cooked file is only used while the hash
+// of its sources (the .obj and its material libraries) still matches; otherwise Model parses
+// the OBJ again and cooks a new one.
+class MeshCache {
+public:
+    // <path without extension>.meshb
+    static std::string cookedPathFor(const std::string &objPath);
+
+    // Maps the cooked file of objPath into file and checks its format, ranges and source hash.
+    // Returns false, leaving file closed, when there is no usable cooked file.
+    static bool open(const std::string &objPath, MappedFile &file);
+
+    // Writes the cooked file of a model parsed from objPath. materialLibraries are relative to
+    // the .obj directory, meshes are the final (material applied) meshes in draw order.
+    static bool cook(const std::string &objPath, const std::vector<std::string> &materialLibraries,
+        const glm::vec3 &minBound, const glm::vec3 &maxBound, const std::vector<MeshData> &meshes);
+
+    // Parses and cooks objPath unless its cooked file is up to date. Needs no GL context.
+    static bool cookIfStale(const std::string &objPath);
+
+    // Hash of the .obj and its material libraries; a missing file hashes as empty
+    static uint64_t hashSources(const std::string &objPath, const std::vector<std::string> &materialLibraries);
+
+    // Models skip the cache entirely when disabled, e.g. to time the OBJ parsers
+    static bool isEnabled() { return enabled.load(); }
+    static void setEnabled(bool value) { enabled.store(value); }
+
+private:
+    static std::atomic<bool> enabled;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+
+// Cooked model file (.meshb), written next to the .obj by MeshCache the first time the model
+// is parsed (or ahead of time with PortalGame --cook-meshes).
+// Layout: MeshHeader, the submesh records, the source records, the interleaved Vertex array of
+// every submesh, the index block of each submesh, then the string table.
+// Everything is plain data with 4-byte alignment, so Model uploads the vertex and index
+// arrays straight out of the memory-mapped file. Strings are offsets into the table and NUL
+// terminated. Values are stored in the byte order of the machine that cooked the file.
+
+constexpr char MESH_MAGIC[4] = { 'P', 'M', 'S', 'H' };
+constexpr uint32_t MESH_VERSION = 1;
+
+struct MeshHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t vertexSize; // sizeof(Vertex) of the cooking build
+    uint32_t sourceHash[2]; // MeshCache::hashSources of the .obj and .mtl files, low word first
+    uint32_t submeshCount;
+    uint32_t sourceCount;
+    uint32_t vertexCount;
+    uint32_t submeshesOffset;
+    uint32_t sourcesOffset;
+    uint32_t verticesOffset;
+    uint32_t stringsOffset;
+    uint32_t stringsSize;
+    float minBound[3];
+    float maxBound[3];
+};
+
+// One mesh of the model (one usemtl group), with its material already applied:
+// the texture coordinates are scaled by the material's textureScale.
+struct MeshSubmeshRecord {
+    uint32_t diffuseMap; // String, empty if the material has none
+    float ambientColor[3];
+    float diffuseColor[3];
+    float specularColor[3];
+    float shininess;
+    uint32_t firstVertex; // Into the vertex array
+    uint32_t vertexCount;
+    uint32_t indicesOffset; // File offset of the index block
+    uint32_t indexCount;
+    uint32_t indexSize; // 2 when every index fits in 16 bits, otherwise 4
+};
+
+// A material library the model was cooked from, relative to the .obj directory
+struct MeshSourceRecord {
+    uint32_t path; // String
+};
@@ -1,15 +1,80 @@
 #include "Model.h"
+#include "MeshCache.h"
 
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <map>
+#include <cstring>
 
 
-Model::Model(std::string const &path) {
+Model::Model(std::string const &path, ModelUpload upload, ObjBackend backend) : sourcePath(path), backend(backend) {
     minBound = glm::vec3(std::numeric_limits<float>::max());
     maxBound = glm::vec3(std::numeric_limits<float>::lowest());
-    loadModel(path);
+    if (upload != ModelUpload::Async) {
+        parse();
+    }
+    if (upload == ModelUpload::Immediate) {
+        this->upload();
+    }
+}
+
+void Model::parse() {
+    loadModel(sourcePath, backend);
+}
+
+Model::~Model() {
+    for (auto &mesh : meshes) {
+        mesh.release();
+    }
+    for (auto &texture : textures_loaded) {
+        glDeleteTextures(1, &texture.ID);
+    }
+}
+
+bool Model::uploadStep() {
+    if (nextImage < pendingImages.size()) {
+        Texture texture(pendingImages[nextImage]);
+        texture.type = "texture_diffuse";
+        textures_loaded.push_back(texture);
+        // Pixels are on the GPU now
+        pendingImages[nextImage] = ImageData();
+        nextImage++;
+    } else if (nextMesh < pendingMeshes.size()) {
+        MeshData &data = pendingMeshes[nextMesh];
+        std::vector<Texture> textures;
+        if (!data.diffuseMap.empty()) {
+            for (unsigned int j = 0; j < textures_loaded.size(); j++) {
+                if (textures_loaded[j].path == data.diffuseMap) {
+                    textures.push_back(textures_loaded[j]);
+                    break;
+                }
+            }
+        }
+        if (data.mappedVertices) {
+            meshes.push_back(Mesh(data.mappedVertices, data.mappedVertexCount, data.mappedIndices, data.mappedIndexCount,
+                data.mappedIndexType, std::move(textures), data.ambientColor, data.diffuseColor, data.specularColor, data.shininess));
+        } else {
+            meshes.push_back(Mesh(std::move(data.vertices), std::move(data.indices), std::move(textures),
+                data.ambientColor, data.diffuseColor, data.specularColor, data.shininess));
+        }
+        data = MeshData();
+        nextMesh++;
+    }
+
+    if (isUploaded()) {
+        pendingImages.clear();
+        pendingMeshes.clear();
+        cooked.close();
+        nextImage = nextMesh = 0;
+        return true;
+    }
+    return false;
+}
+
+void Model::upload() {
+    while (!uploadStep()) {
+    }
 }
 
 glm::vec3 Model::getCenter() const {
@@ -91,169 +156,100 @@ void Model::loadMTL(std::string const &path) {
     }
 }
 
-void Model::loadModel(std::string const &path) {
-    std::ifstream file(path);
-    if (!file.is_open()) {
-        std::cout << "Failed to open OBJ file: " << path << std::endl;
+void Model::loadModel(std::string const &path, ObjBackend backend) {
+    directory = path.substr(0, path.find_last_of('/'));
+    if (MeshCache::isEnabled() && loadCooked(path)) {
         return;
     }
 
-    directory = path.substr(0, path.find_last_of('/'));
-
-    std::vector<glm::vec3> temp_positions;
-    std::vector<glm::vec2> temp_texCoords;
-    std::vector<glm::vec3> temp_normals;
-
-    // Per-mesh data
-    std::vector<Vertex> vertices;
-    std::vector<unsigned int> indices;
-    std::vector<Texture> textures;
-
-    // Map unique vertex string "v/vt/vn" to index
-    std::map<std::string, unsigned int> uniqueVertices;
-
-    std::string line;
-    std::string currentMaterial = "";
-
-    // Helper to flush current mesh
-    auto flushMesh = [&]() {
-        if (!vertices.empty()) {
-            glm::vec3 ambient = glm::vec3(1.0f);
-            glm::vec3 diffuse = glm::vec3(1.0f);
-            glm::vec3 specular = glm::vec3(0.5f);
-            float shininess = 32.0f;
-
-            if (materials.find(currentMaterial) != materials.end()) {
-                ambient = materials[currentMaterial].ambientColor;
-                diffuse = materials[currentMaterial].diffuseColor;
-                specular = materials[currentMaterial].specularColor;
-                shininess = materials[currentMaterial].shininess;
+    ObjData data;
+    if (!ObjLoader::load(path, backend, data)) {
+        return;
+    }
+    minBound = data.minBound;
+    maxBound = data.maxBound;
+    for (const std::string &library : data.materialLibraries) {
+        loadMTL(directory + "/" + library);
+    }
 
-                glm::vec2 scale = materials[currentMaterial].textureScale;
-                if (scale.x != 1.0f || scale.y != 1.0f) {
-                    for (auto &v : vertices) {
-                        v.TexCoords.x *= scale.x;
-                        v.TexCoords.y *= scale.y;
-                    }
+    // Turn the groups into meshes waiting for upload, decoding each diffuse map once
+    pendingMeshes.reserve(data.meshes.size());
+    for (ObjMesh &group : data.meshes) {
+        MeshData mesh;
+        auto material = materials.find(group.material);
+        if (material != materials.end()) {
+            mesh.diffuseMap = material->second.diffuseMap;
+            mesh.ambientColor = material->second.ambientColor;
+            mesh.diffuseColor = material->second.diffuseColor;
+            mesh.specularColor = material->second.specularColor;
+            mesh.shininess = material->second.shininess;
+
+            glm::vec2 scale = material->second.textureScale;
+            if (scale.x != 1.0f || scale.y != 1.0f) {
+                for (auto &v : group.vertices) {
+                    v.TexCoords.x *= scale.x;
+                    v.TexCoords.y *= scale.y;
                 }
             }
-            meshes.push_back(Mesh(vertices, indices, textures, ambient, diffuse, specular, shininess));
-            vertices.clear();
-            indices.clear();
-            textures.clear();
-            uniqueVertices.clear();
         }
-        };
-
-    while (std::getline(file, line)) {
-        std::stringstream ss(line);
-        std::string prefix;
-        ss >> prefix;
-
-        if (prefix == "mtllib") {
-            std::string mtlFile;
-            std::getline(ss, mtlFile);
-            // Trim leading whitespace
-            size_t first = mtlFile.find_first_not_of(' ');
-            if (std::string::npos != first) {
-                mtlFile = mtlFile.substr(first);
-            }
-            loadMTL(directory + "/" + mtlFile);
-        } else if (prefix == "usemtl") {
-            flushMesh(); // Start new mesh on material change
-            ss >> currentMaterial;
-
-            // Load textures for this material
-            if (materials.find(currentMaterial) != materials.end()) {
-                // Diffuse map
-                std::string diffPath = materials[currentMaterial].diffuseMap;
-                if (!diffPath.empty()) {
-                    bool skip = false;
-                    for (unsigned int j = 0; j < textures_loaded.size(); j++) {
-                        if (std::strcmp(textures_loaded[j].path.data(), diffPath.c_str()) == 0) {
-                            textures.push_back(textures_loaded[j]);
-                            skip = true;
-                            break;
-                        }
-                    }
-                    if (!skip) {
-                        Texture texture(diffPath.c_str(), directory);
-                        texture.type = "texture_diffuse";
-                        textures.push_back(texture);
-                        textures_loaded.push_back(texture);
-                    }
-                }
-            }
-        } else if (prefix == "v") {
-            glm::vec3 pos;
-            ss >> pos.x >> pos.y >> pos.z;
-            temp_positions.push_back(pos);
 
-            // Update bounds
-            if (pos.x < minBound.x) minBound.x = pos.x;
-            if (pos.y < minBound.y) minBound.y = pos.y;
-            if (pos.z < minBound.z) minBound.z = pos.z;
-            if (pos.x > maxBound.x) maxBound.x = pos.x;
-            if (pos.y > maxBound.y) maxBound.y = pos.y;
-            if (pos.z > maxBound.z) maxBound.z = pos.z;
-        } else if (prefix == "vt") {
-            glm::vec2 tex;
-            ss >> tex.x >> tex.y;
-            temp_texCoords.push_back(tex);
-        } else if (prefix == "vn") {
-            glm::vec3 norm;
-            ss >> norm.x >> norm.y >> norm.z;
-            temp_normals.push_back(norm);
-        } else if (prefix == "f") {
-            std::string vertexStr;
-            std::vector<std::string> faceVertices;
-            while (ss >> vertexStr) {
-                faceVertices.push_back(vertexStr);
-            }
-
-            // Triangulate (fan)
-            for (size_t i = 1; i < faceVertices.size() - 1; ++i) {
-                std::string v[3] = { faceVertices[0], faceVertices[i], faceVertices[i + 1] };
-
-                for (int j = 0; j < 3; ++j) {
-                    if (uniqueVertices.count(v[j]) == 0) {
-                        uniqueVertices[v[j]] = static_cast<unsigned int>(vertices.size());
-
-                        Vertex vertex;
-                        std::stringstream vss(v[j]);
-                        std::string segment;
-                        std::vector<std::string> indicesStr;
-
-                        while (std::getline(vss, segment, '/')) {
-                            indicesStr.push_back(segment);
-                        }
+        decodeDiffuseMap(mesh.diffuseMap);
+        mesh.vertices = std::move(group.vertices);
+        mesh.indices = std::move(group.indices);
+        pendingMeshes.push_back(std::move(mesh));
+    }
 
-                        // Position
-                        int posIdx = std::stoi(indicesStr[0]) - 1;
-                        vertex.Position = temp_positions[posIdx];
+    // Next time the model maps the cooked file instead of parsing
+    if (MeshCache::isEnabled()) {
+        MeshCache::cook(path, data.materialLibraries, minBound, maxBound, pendingMeshes);
+    }
+}
 
-                        // TexCoord
-                        if (indicesStr.size() > 1 && !indicesStr[1].empty()) {
-                            int texIdx = std::stoi(indicesStr[1]) - 1;
-                            vertex.TexCoords = temp_texCoords[texIdx];
-                        } else {
-                            vertex.TexCoords = glm::vec2(0.0f, 0.0f);
-                        }
+bool Model::loadCooked(std::string const &path) {
+    if (!MeshCache::open(path, cooked)) {
+        return false;
+    }
 
-                        // Normal
-                        if (indicesStr.size() > 2 && !indicesStr[2].empty()) {
-                            int normIdx = std::stoi(indicesStr[2]) - 1;
-                            vertex.Normal = temp_normals[normIdx];
-                        } else {
-                            vertex.Normal = glm::vec3(0.0f, 0.0f, 0.0f);
-                        }
+    // MeshCache::open checked every offset and count used here
+    const uint8_t *base = cooked.data();
+    const MeshHeader *header = reinterpret_cast<const MeshHeader *>(base);
+    const auto *submeshes = reinterpret_cast<const MeshSubmeshRecord *>(base + header->submeshesOffset);
+    const Vertex *vertices = reinterpret_cast<const Vertex *>(base + header->verticesOffset);
+    const char *strings = reinterpret_cast<const char *>(base + header->stringsOffset);
+
+    minBound = glm::vec3(header->minBound[0], header->minBound[1], header->minBound[2]);
+    maxBound = glm::vec3(header->maxBound[0], header->maxBound[1], header->maxBound[2]);
+    pendingMeshes.reserve(header->submeshCount);
+    for (uint32_t i = 0; i < header->submeshCount; ++i) {
+        const MeshSubmeshRecord &submesh = submeshes[i];
+        MeshData mesh;
+        mesh.diffuseMap = strings + submesh.diffuseMap;
+        mesh.ambientColor = glm::vec3(submesh.ambientColor[0], submesh.ambientColor[1], submesh.ambientColor[2]);
+        mesh.diffuseColor = glm::vec3(submesh.diffuseColor[0], submesh.diffuseColor[1], submesh.diffuseColor[2]);
+        mesh.specularColor = glm::vec3(submesh.specularColor[0], submesh.specularColor[1], submesh.specularColor[2]);
+        mesh.shininess = submesh.shininess;
+        mesh.mappedVertices = vertices + submesh.firstVertex;
+        mesh.mappedVertexCount = submesh.vertexCount;
+        mesh.mappedIndices = base + submesh.indicesOffset;
+        mesh.mappedIndexCount = submesh.indexCount;
+        mesh.mappedIndexType = submesh.indexSize == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+        decodeDiffuseMap(mesh.diffuseMap);
+        pendingMeshes.push_back(std::move(mesh));
+    }
+    return true;
+}
 
-                        vertices.push_back(vertex);
-                    }
-                    indices.push_back(uniqueVertices[v[j]]);
-                }
-            }
+void Model::decodeDiffuseMap(std::string const &diffuseMap) {
+    if (diffuseMap.empty()) {
+        return;
+    }
+    for (unsigned int j = 0; j < pendingImages.size(); j++) {
+        if (pendingImages[j].path == diffuseMap) {
+            return;
         }
     }
-    flushMesh();
+    ImageData image;
+    Texture::DecodeFile(diffuseMap.c_str(), directory, image);
+    pendingImages.push_back(std::move(image));
 }
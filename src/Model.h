@@ -1,6 +1,8 @@
 #pragma once
 
+#include "MappedFile.h"
 #include "Mesh.h"
+#include "ObjLoader.h"
 #include "Shader.h"
 
 #include <string>
@@ -15,6 +17,34 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <stb_image.h>
 
+// CPU side of a mesh, parsed from the OBJ and kept until it is uploaded
+struct MeshData {
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    // Set instead of vertices/indices when the mesh comes from a cooked file (views into the mapping)
+    const Vertex *mappedVertices = nullptr;
+    const void *mappedIndices = nullptr;
+    size_t mappedVertexCount = 0;
+    size_t mappedIndexCount = 0;
+    GLenum mappedIndexType = GL_UNSIGNED_INT;
+    std::string diffuseMap; // Relative to the model directory, empty if the material has none
+    glm::vec3 ambientColor = glm::vec3(1.0f);
+    glm::vec3 diffuseColor = glm::vec3(1.0f);
+    glm::vec3 specularColor = glm::vec3(0.5f);
+    float shininess = 32.0f;
+};
+
+// Immediate parses and uploads in the constructor (needs the GL context).
+// Deferred only parses the files and decodes the textures, which is safe on a loader thread;
+// uploadStep()/upload() must then run on the GL thread before the model is drawn.
+// Async does neither: parse() runs later (e.g. on an AssetLoader worker), then the upload as
+// for Deferred. The model can be handed out and drawn before that, it just draws nothing.
+enum class ModelUpload {
+    Immediate,
+    Deferred,
+    Async
+};
+
 class Model {
 public:
     // model data 
@@ -23,11 +53,32 @@ public:
     std::string directory;
 
     // constructor, expects a filepath to a 3D model.
-    Model(std::string const &path);
+    Model(std::string const &path, ModelUpload upload = ModelUpload::Immediate, ObjBackend backend = ObjLoader::getDefaultBackend());
+    // Frees the GL buffers and textures, so it must run on the GL thread once anything was uploaded
+    ~Model();
+
+    Model(const Model &) = delete;
+    Model &operator=(const Model &) = delete;
+
+    // Parse half of the constructor for ModelUpload::Async models; no GL, any thread, once.
+    // The bounds are only valid afterwards.
+    void parse();
 
     // draws the model, and thus all its meshes
     void Draw(Shader &shader);
 
+    // Uploads one texture or mesh still waiting on the CPU. Returns true once nothing is left,
+    // which lets the caller spread a big upload over several frames.
+    bool uploadStep();
+    void upload();
+    bool isUploaded() const { return nextImage == pendingImages.size() && nextMesh == pendingMeshes.size(); }
+
+    // Number of scene objects using the model (Scene::addObject / removeObject), plus explicit
+    // retains for users outside the scene. Scene::unloadUnusedModels drops models at zero.
+    void retain() { refCount++; }
+    void release() { if (refCount > 0) refCount--; }
+    int getRefCount() const { return refCount; }
+
     // Bounding box
     glm::vec3 minBound;
     glm::vec3 maxBound;
@@ -35,10 +86,16 @@ public:
     float getNormalizationScale() const;
 
 private:
-    // loads a model with supported OBJ extensions from file and stores the resulting meshes in the meshes vector.
-    void loadModel(std::string const &path);
+    std::string sourcePath;
+    ObjBackend backend;
+
+    // Parses the OBJ (see ObjLoader) and its materials into pendingMeshes/pendingImages,
+    // or maps its cooked file (see MeshCache) when that is up to date
+    void loadModel(std::string const &path, ObjBackend backend);
+    bool loadCooked(std::string const &path);
+    // Queues the decode of a diffuse map unless an earlier mesh already did
+    void decodeDiffuseMap(std::string const &diffuseMap);
 
-    // Custom OBJ parser helpers
     struct Material {
         std::string name;
         std::string diffuseMap;
@@ -51,4 +108,13 @@ private:
 
     std::map<std::string, Material> materials;
     void loadMTL(std::string const &path);
+
+    // Parsed and decoded data waiting for upload, in upload order (textures before the meshes using them)
+    std::vector<ImageData> pendingImages;
+    std::vector<MeshData> pendingMeshes;
+    MappedFile cooked; // Backs the mapped meshes until they are uploaded
+    size_t nextImage = 0;
+    size_t nextMesh = 0;
+
+    int refCount = 0;
 };
@@ -0,0 +1,588 @@
+#include "ObjLoader.h"
+#include "JobSystem.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string_view>
+#include <thread>
+
+#define TINYOBJ_LOADER_OPT_IMPLEMENTATION
+#include <tinyobj_loader_opt.h>
+
+namespace {
+
+void growBounds(ObjData &out, const glm::vec3 &pos) {
+    if (pos.x < out.minBound.x) out.minBound.x = pos.x;
+    if (pos.y < out.minBound.y) out.minBound.y = pos.y;
+    if (pos.z < out.minBound.z) out.minBound.z = pos.z;
+    if (pos.x > out.maxBound.x) out.maxBound.x = pos.x;
+    if (pos.y > out.maxBound.y) out.maxBound.y = pos.y;
+    if (pos.z > out.maxBound.z) out.maxBound.z = pos.z;
+}
+
+// Ends the current usemtl group; groups without faces are dropped
+void flushMesh(ObjData &out, ObjMesh &mesh) {
+    if (!mesh.vertices.empty()) {
+        out.meshes.push_back(std::move(mesh));
+    }
+    mesh = ObjMesh();
+}
+
+// Parses the float at the start of [first, last). Returns the end of the number, or nullptr
+// when there is none.
+const char *parseFloat(const char *first, const char *last, float &value) {
+#if defined(__cpp_lib_to_chars)
+    auto result = std::from_chars(first, last, value);
+    return result.ec == std::errc() ? result.ptr : nullptr;
+#else
+    // Older libc++ (Apple) has no floating-point from_chars. strtof needs a terminator, which
+    // the mapped file does not have, so the number is copied out first.
+    char buffer[64];
+    size_t length = 0;
+    while (first + length < last && length + 1 < sizeof(buffer) && std::strchr("0123456789+-.eE", first[length])) {
+        length++;
+    }
+    std::memcpy(buffer, first, length);
+    buffer[length] = '\0';
+    char *parsed = buffer;
+    value = std::strtof(buffer, &parsed);
+    return parsed != buffer ? first + (parsed - buffer) : nullptr;
+#endif
+}
+
+// Cursor over the mapped text. Lines end at '\n'; '\r' counts as blank space.
+class ObjScanner {
+public:
+    ObjScanner(const char *begin, const char *end) : cursor(begin), end(end) {}
+
+    bool atEnd() const { return cursor >= end; }
+
+    static bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+    void skipBlanks() {
+        while (cursor < end && isBlank(*cursor)) cursor++;
+    }
+
+    bool atLineEnd() {
+        skipBlanks();
+        return cursor >= end || *cursor == '\n';
+    }
+
+    void nextLine() {
+        while (cursor < end && *cursor != '\n') cursor++;
+        if (cursor < end) cursor++;
+    }
+
+    // Next run of non-blank characters on this line, empty at the end of the line
+    std::string_view token() {
+        skipBlanks();
+        const char *start = cursor;
+        while (cursor < end && *cursor != '\n' && !isBlank(*cursor)) cursor++;
+        return std::string_view(start, static_cast<size_t>(cursor - start));
+    }
+
+    // The rest of the line without surrounding blanks
+    std::string_view rest() {
+        skipBlanks();
+        const char *start = cursor;
+        while (cursor < end && *cursor != '\n') cursor++;
+        const char *last = cursor;
+        while (last > start && isBlank(last[-1])) last--;
+        return std::string_view(start, static_cast<size_t>(last - start));
+    }
+
+    // Missing or malformed values read as 0, like the stream parser
+    float number() {
+        skipBlanks();
+        float value = 0.0f;
+        if (cursor < end && *cursor == '+') cursor++; // from_chars takes no explicit plus
+        if (const char *next = parseFloat(cursor, end, value)) {
+            cursor = next;
+        } else {
+            // Skip the bad token
+            token();
+        }
+        return value;
+    }
+
+private:
+    const char *cursor;
+    const char *end;
+};
+
+// One face corner: 1-based position/texcoord/normal indices, 0 where absent
+struct VertexKey {
+    int position;
+    int texCoord;
+    int normal;
+
+    bool operator==(const VertexKey &other) const {
+        return position == other.position && texCoord == other.texCoord && normal == other.normal;
+    }
+};
+
+// Negative indices count back from the last element read so far (-1 is the latest)
+int resolveIndex(int index, size_t count) {
+    return index < 0 ? static_cast<int>(count) + index + 1 : index;
+}
+
+// Parses "v", "v/vt", "v//vn" or "v/vt/vn", resolving relative indices against the attribute counts
+VertexKey parseFaceVertex(std::string_view token, size_t positionCount, size_t texCoordCount, size_t normalCount) {
+    int indices[3] = { 0, 0, 0 };
+    const char *cursor = token.data();
+    const char *end = token.data() + token.size();
+    for (int slot = 0; slot < 3 && cursor < end; ++slot) {
+        if (*cursor != '/') {
+            auto result = std::from_chars(cursor, end, indices[slot]);
+            cursor = result.ptr;
+        }
+        // Move past this field and its '/'
+        while (cursor < end && *cursor != '/') cursor++;
+        if (cursor < end) cursor++;
+    }
+    return { resolveIndex(indices[0], positionCount), resolveIndex(indices[1], texCoordCount), resolveIndex(indices[2], normalCount) };
+}
+
+// Open-addressing (linear probing) map from VertexKey to the vertex index in the current mesh.
+// clear() bumps a generation instead of wiping the slots, so starting a new usemtl group is free.
+class VertexTable {
+public:
+    explicit VertexTable(size_t expectedVertices) {
+        size_t capacity = 64;
+        while (capacity < expectedVertices * 2) capacity *= 2;
+        slots.resize(capacity);
+    }
+
+    void clear() {
+        count = 0;
+        if (++generation == 0) {
+            // Wrapped around: stale slots could look live again
+            std::fill(slots.begin(), slots.end(), Slot());
+            generation = 1;
+        }
+    }
+
+    // Index stored for key, or next after storing it there (inserted is set then)
+    unsigned int findOrInsert(const VertexKey &key, unsigned int next, bool &inserted) {
+        if ((count + 1) * 4 > slots.size() * 3) {
+            grow();
+        }
+        size_t mask = slots.size() - 1;
+        for (size_t i = hash(key) & mask;; i = (i + 1) & mask) {
+            Slot &slot = slots[i];
+            if (slot.generation != generation) {
+                slot.key = key;
+                slot.index = next;
+                slot.generation = generation;
+                count++;
+                inserted = true;
+                return next;
+            }
+            if (slot.key == key) {
+                inserted = false;
+                return slot.index;
+            }
+        }
+    }
+
+private:
+    struct Slot {
+        VertexKey key = { 0, 0, 0 };
+        unsigned int index = 0;
+        unsigned int generation = 0; // Live when equal to the table's generation
+    };
+
+    std::vector<Slot> slots;
+    size_t count = 0;
+    unsigned int generation = 1;
+
+    static size_t hash(const VertexKey &key) {
+        uint64_t h = static_cast<uint32_t>(key.position) * 0x9E3779B97F4A7C15ull;
+        h ^= static_cast<uint32_t>(key.texCoord) * 0xC2B2AE3D27D4EB4Full;
+        h ^= static_cast<uint32_t>(key.normal) * 0x165667B19E3779F9ull;
+        return static_cast<size_t>(h ^ (h >> 29));
+    }
+
+    void grow() {
+        std::vector<Slot> old(slots.size() * 2);
+        old.swap(slots);
+        size_t mask = slots.size() - 1;
+        for (const Slot &slot : old) {
+            if (slot.generation != generation) continue;
+            size_t i = hash(slot.key) & mask;
+            while (slots[i].generation == generation) i = (i + 1) & mask;
+            slots[i] = slot;
+        }
+    }
+};
+
+// Number of face lines, used to size the vertex table before parsing
+size_t countFaces(const char *text, size_t size) {
+    size_t faces = 0;
+    const char *end = text + size;
+    for (const char *line = text; line < end;) {
+        if (end - line > 1 && line[0] == 'f' && ObjScanner::isBlank(line[1])) faces++;
+        const char *newline = static_cast<const char *>(std::memchr(line, '\n', static_cast<size_t>(end - line)));
+        if (!newline) break;
+        line = newline + 1;
+    }
+    return faces;
+}
+
+template <typename T>
+T attribute(const std::vector<T> &values, int oneBasedIndex) {
+    size_t index = static_cast<size_t>(oneBasedIndex - 1);
+    return oneBasedIndex > 0 && index < values.size() ? values[index] : T(0.0f);
+}
+
+// tinyobj index (0-based, negative when absent) to a VertexKey field
+int tinyObjKey(int index) {
+    return index >= 0 ? index + 1 : 0;
+}
+
+template <typename Values>
+glm::vec3 tinyObjVec3(const Values &values, int oneBasedIndex) {
+    size_t index = static_cast<size_t>(oneBasedIndex - 1) * 3;
+    return oneBasedIndex > 0 && index + 2 < values.size() ? glm::vec3(values[index], values[index + 1], values[index + 2]) : glm::vec3(0.0f);
+}
+
+template <typename Values>
+glm::vec2 tinyObjVec2(const Values &values, int oneBasedIndex) {
+    size_t index = static_cast<size_t>(oneBasedIndex - 1) * 2;
+    return oneBasedIndex > 0 && index + 1 < values.size() ? glm::vec2(values[index], values[index + 1]) : glm::vec2(0.0f);
+}
+
+// Small files are not worth a thread per chunk
+constexpr size_t TINYOBJ_BYTES_PER_THREAD = 256 * 1024;
+
+} // namespace
+
+std::atomic<ObjBackend> ObjLoader::defaultBackend(ObjBackend::Mapped);
+
+bool ObjLoader::load(const std::string &path, ObjBackend backend, ObjData &out) {
+    out = ObjData();
+    switch (backend) {
+    case ObjBackend::Stream:
+        return loadStream(path, out);
+    case ObjBackend::TinyObj:
+        return loadTinyObj(path, out);
+    case ObjBackend::Mapped:
+    default:
+        return loadMapped(path, out);
+    }
+}
+
+bool ObjLoader::backendFromName(const std::string &name, ObjBackend &backend) {
+    for (ObjBackend candidate : { ObjBackend::Stream, ObjBackend::Mapped, ObjBackend::TinyObj }) {
+        if (name == backendName(candidate)) {
+            backend = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *ObjLoader::backendName(ObjBackend backend) {
+    switch (backend) {
+    case ObjBackend::Stream:
+        return "stream";
+    case ObjBackend::TinyObj:
+        return "tinyobj";
+    case ObjBackend::Mapped:
+    default:
+        return "mapped";
+    }
+}
+
+bool ObjLoader::loadStream(const std::string &path, ObjData &out) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cout << "Failed to open OBJ file: " << path << std::endl;
+        return false;
+    }
+
+    std::vector<glm::vec3> temp_positions;
+    std::vector<glm::vec2> temp_texCoords;
+    std::vector<glm::vec3> temp_normals;
+
+    // Per-mesh data
+    ObjMesh mesh;
+
+    // Map unique vertex string "v/vt/vn" to index
+    std::map<std::string, unsigned int> uniqueVertices;
+
+    std::string line;
+    while (std::getline(file, line)) {
+        std::stringstream ss(line);
+        std::string prefix;
+        ss >> prefix;
+
+        if (prefix == "mtllib") {
+            std::string mtlFile;
+            std::getline(ss, mtlFile);
+            // Trim leading whitespace
+            size_t first = mtlFile.find_first_not_of(' ');
+            if (std::string::npos != first) {
+                mtlFile = mtlFile.substr(first);
+            }
+            out.materialLibraries.push_back(mtlFile);
+        } else if (prefix == "usemtl") {
+            flushMesh(out, mesh); // Start new mesh on material change
+            uniqueVertices.clear();
+            ss >> mesh.material;
+        } else if (prefix == "v") {
+            glm::vec3 pos;
+            ss >> pos.x >> pos.y >> pos.z;
+            temp_positions.push_back(pos);
+            growBounds(out, pos);
+        } else if (prefix == "vt") {
+            glm::vec2 tex;
+            ss >> tex.x >> tex.y;
+            temp_texCoords.push_back(tex);
+        } else if (prefix == "vn") {
+            glm::vec3 norm;
+            ss >> norm.x >> norm.y >> norm.z;
+            temp_normals.push_back(norm);
+        } else if (prefix == "f") {
+            std::string vertexStr;
+            std::vector<std::string> faceVertices;
+            while (ss >> vertexStr) {
+                faceVertices.push_back(vertexStr);
+            }
+
+            // Triangulate (fan)
+            for (size_t i = 1; i + 1 < faceVertices.size(); ++i) {
+                std::string v[3] = { faceVertices[0], faceVertices[i], faceVertices[i + 1] };
+
+                for (int j = 0; j < 3; ++j) {
+                    if (uniqueVertices.count(v[j]) == 0) {
+                        uniqueVertices[v[j]] = static_cast<unsigned int>(mesh.vertices.size());
+
+                        Vertex vertex;
+                        std::stringstream vss(v[j]);
+                        std::string segment;
+                        std::vector<std::string> indicesStr;
+
+                        while (std::getline(vss, segment, '/')) {
+                            indicesStr.push_back(segment);
+                        }
+
+                        // Position
+                        int posIdx = std::stoi(indicesStr[0]) - 1;
+                        vertex.Position = temp_positions[posIdx];
+
+                        // TexCoord
+                        if (indicesStr.size() > 1 && !indicesStr[1].empty()) {
+                            int texIdx = std::stoi(indicesStr[1]) - 1;
+                            vertex.TexCoords = temp_texCoords[texIdx];
+                        } else {
+                            vertex.TexCoords = glm::vec2(0.0f, 0.0f);
+                        }
+
+                        // Normal
+                        if (indicesStr.size() > 2 && !indicesStr[2].empty()) {
+                            int normIdx = std::stoi(indicesStr[2]) - 1;
+                            vertex.Normal = temp_normals[normIdx];
+                        } else {
+                            vertex.Normal = glm::vec3(0.0f, 0.0f, 0.0f);
+                        }
+
+                        mesh.vertices.push_back(vertex);
+                    }
+                    mesh.indices.push_back(uniqueVertices[v[j]]);
+                }
+            }
+        }
+    }
+    flushMesh(out, mesh);
+    return true;
+}
+
+bool ObjLoader::loadMapped(const std::string &path, ObjData &out) {
+    MappedFile file;
+    if (!file.open(path)) {
+        std::cout << "Failed to open OBJ file: " << path << std::endl;
+        return false;
+    }
+
+    const char *text = reinterpret_cast<const char *>(file.data());
+    ObjScanner scanner(text, text + file.size());
+
+    // Rough counts from the file size keep the attribute arrays from regrowing
+    size_t estimatedLines = file.size() / 32;
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> texCoords;
+    std::vector<glm::vec3> normals;
+    positions.reserve(estimatedLines / 3);
+    texCoords.reserve(estimatedLines / 3);
+    normals.reserve(estimatedLines / 3);
+
+    ObjMesh mesh;
+    // Welded vertices of the current mesh; a triangle mesh has about as many as it has faces
+    VertexTable uniqueVertices(countFaces(text, file.size()));
+    // Corners and vertex indices of the face being read, reused from face to face
+    std::vector<VertexKey> corners;
+    std::vector<unsigned int> face;
+
+    while (!scanner.atEnd()) {
+        std::string_view keyword = scanner.token();
+
+        if (keyword == "v") {
+            glm::vec3 pos;
+            pos.x = scanner.number();
+            pos.y = scanner.number();
+            pos.z = scanner.number();
+            positions.push_back(pos);
+            growBounds(out, pos);
+        } else if (keyword == "vt") {
+            glm::vec2 tex;
+            tex.x = scanner.number();
+            tex.y = scanner.number();
+            texCoords.push_back(tex);
+        } else if (keyword == "vn") {
+            glm::vec3 norm;
+            norm.x = scanner.number();
+            norm.y = scanner.number();
+            norm.z = scanner.number();
+            normals.push_back(norm);
+        } else if (keyword == "f") {
+            corners.clear();
+            while (!scanner.atLineEnd()) {
+                corners.push_back(parseFaceVertex(scanner.token(), positions.size(), texCoords.size(), normals.size()));
+            }
+            if (corners.size() < 3) {
+                scanner.nextLine();
+                continue;
+            }
+
+            face.clear();
+            for (const VertexKey &corner : corners) {
+                bool inserted;
+                unsigned int index = uniqueVertices.findOrInsert(corner, static_cast<unsigned int>(mesh.vertices.size()), inserted);
+                if (inserted) {
+                    Vertex vertex;
+                    vertex.Position = attribute(positions, corner.position);
+                    vertex.TexCoords = attribute(texCoords, corner.texCoord);
+                    vertex.Normal = attribute(normals, corner.normal);
+                    mesh.vertices.push_back(vertex);
+                }
+                face.push_back(index);
+            }
+
+            // Triangulate (fan)
+            for (size_t i = 1; i + 1 < face.size(); ++i) {
+                mesh.indices.push_back(face[0]);
+                mesh.indices.push_back(face[i]);
+                mesh.indices.push_back(face[i + 1]);
+            }
+        } else if (keyword == "usemtl") {
+            flushMesh(out, mesh); // Start new mesh on material change
+            uniqueVertices.clear();
+            mesh.material = std::string(scanner.token());
+        } else if (keyword == "mtllib") {
+            out.materialLibraries.emplace_back(scanner.rest());
+        }
+        // Comments, groups, smoothing groups and anything unknown are skipped
+        scanner.nextLine();
+    }
+    flushMesh(out, mesh);
+    return true;
+}
+
+bool ObjLoader::loadTinyObj(const std::string &path, ObjData &out) {
+    MappedFile file;
+    if (!file.open(path)) {
+        std::cout << "Failed to open OBJ file: " << path << std::endl;
+        return false;
+    }
+    const char *text = reinterpret_cast<const char *>(file.data());
+
+    // tinyobj only reports material ids from an mtllib it opens relative to the working
+    // directory, so the usemtl boundaries and library names come from a quick line scan.
+    // Materials themselves stay with Model::loadMTL, as for the other backends.
+    struct MaterialGroup {
+        size_t firstFace; // Index of the first "f" line using it
+        std::string material;
+    };
+    std::vector<MaterialGroup> groups;
+    size_t faceLines = 0;
+    for (ObjScanner scanner(text, text + file.size()); !scanner.atEnd(); scanner.nextLine()) {
+        std::string_view keyword = scanner.token();
+        if (keyword == "f") {
+            faceLines++;
+        } else if (keyword == "usemtl") {
+            groups.push_back({ faceLines, std::string(scanner.token()) });
+        } else if (keyword == "mtllib") {
+            out.materialLibraries.emplace_back(scanner.rest());
+        }
+    }
+
+    // Faces are kept as polygons (one face_num_verts entry per "f" line) and fanned below
+    tinyobj_opt::LoadOption option;
+    option.triangulate = false;
+    // Inside a pool (AssetLoader, LevelStreamer) the other models already keep the cores busy
+    size_t threads = JobSystem::isInJob() ? 1 : std::max<size_t>(1, std::thread::hardware_concurrency());
+    option.req_num_threads = static_cast<int>(std::min(threads, file.size() / TINYOBJ_BYTES_PER_THREAD + 1));
+
+    tinyobj_opt::attrib_t attrib;
+    std::vector<tinyobj_opt::shape_t> shapes;
+    std::vector<tinyobj_opt::material_t> materials;
+    if (!tinyobj_opt::parseObj(&attrib, &shapes, &materials, text, file.size(), option)) {
+        std::cout << "Failed to parse OBJ file: " << path << std::endl;
+        return false;
+    }
+
+    for (size_t i = 0; i + 2 < attrib.vertices.size(); i += 3) {
+        growBounds(out, glm::vec3(attrib.vertices[i], attrib.vertices[i + 1], attrib.vertices[i + 2]));
+    }
+
+    ObjMesh mesh;
+    VertexTable uniqueVertices(attrib.face_num_verts.size());
+    std::vector<unsigned int> face;
+    size_t nextGroup = 0;
+    size_t firstCorner = 0;
+    for (size_t f = 0; f < attrib.face_num_verts.size(); ++f) {
+        while (nextGroup < groups.size() && groups[nextGroup].firstFace == f) {
+            flushMesh(out, mesh); // Start new mesh on material change
+            uniqueVertices.clear();
+            mesh.material = groups[nextGroup++].material;
+        }
+
+        size_t cornerCount = static_cast<size_t>(std::max(attrib.face_num_verts[f], 0));
+        if (cornerCount >= 3 && firstCorner + cornerCount <= attrib.indices.size()) {
+            face.clear();
+            for (size_t c = firstCorner; c < firstCorner + cornerCount; ++c) {
+                const tinyobj_opt::index_t &index = attrib.indices[c];
+                VertexKey corner = { tinyObjKey(index.vertex_index), tinyObjKey(index.texcoord_index), tinyObjKey(index.normal_index) };
+                bool inserted;
+                unsigned int vertexIndex = uniqueVertices.findOrInsert(corner, static_cast<unsigned int>(mesh.vertices.size()), inserted);
+                if (inserted) {
+                    Vertex vertex;
+                    vertex.Position = tinyObjVec3(attrib.vertices, corner.position);
+                    vertex.TexCoords = tinyObjVec2(attrib.texcoords, corner.texCoord);
+                    vertex.Normal = tinyObjVec3(attrib.normals, corner.normal);
+                    mesh.vertices.push_back(vertex);
+                }
+                face.push_back(vertexIndex);
+            }
+
+            // Triangulate (fan)
+            for (size_t i = 1; i + 1 < face.size(); ++i) {
+                mesh.indices.push_back(face[0]);
+                mesh.indices.push_back(face[i]);
+                mesh.indices.push_back(face[i + 1]);
+            }
+        }
+        firstCorner += cornerCount;
+    }
+    flushMesh(out, mesh);
+    return true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Mesh.h"
+
+#include <atomic>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Parser used to read .obj files
+enum class ObjBackend {
+    Stream,  // Original line/stringstream parser, kept as the reference
+    Mapped,  // Memory-mapped scan with from_chars, no per line or per token allocations;
+             // also accepts negative (relative) face indices
+    TinyObj  // tinyobjloader's optimized loader: the file is split into chunks parsed on several threads
+};
+
+// Geometry of one usemtl group, with its vertices deduplicated on their v/vt/vn indices
+struct ObjMesh {
+    std::string material;
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+};
+
+// Everything Model needs from an .obj file. Materials are only referenced by name;
+// the libraries are listed in file order, relative to the .obj directory.
+struct ObjData {
+    std::vector<std::string> materialLibraries;
+    std::vector<ObjMesh> meshes; // One per usemtl group, in file order, empty groups dropped
+    glm::vec3 minBound = glm::vec3(std::numeric_limits<float>::max());
+    glm::vec3 maxBound = glm::vec3(std::numeric_limits<float>::lowest());
+};
+
+// Reads the geometry of an .obj file: positions, texture coordinates and normals, polygon faces
+// fan-triangulated, meshes split on usemtl, and the position bounds. Every backend produces the
+// same ObjData for the same file (Stream does not support relative indices).
+class ObjLoader {
+public:
+    static bool load(const std::string &path, ObjBackend backend, ObjData &out);
+
+    // Backend used by models that do not ask for one; can be switched at runtime to compare them
+    static ObjBackend getDefaultBackend() { return defaultBackend.load(); }
+    static void setDefaultBackend(ObjBackend backend) { defaultBackend.store(backend); }
+
+    // "stream", "mapped" or "tinyobj"
+    static bool backendFromName(const std::string &name, ObjBackend &backend);
+    static const char *backendName(ObjBackend backend);
+
+private:
+    static std::atomic<ObjBackend> defaultBackend;
+
+    static bool loadStream(const std::string &path, ObjData &out);
+    static bool loadMapped(const std::string &path, ObjData &out);
+    static bool loadTinyObj(const std::string &path, ObjData &out);
+};
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Fixed-size blocks carved out of larger chunks. Freed blocks go onto an intrusive free list
+// and are handed out again before any new chunk is allocated, so once reserve() has made
+// room, allocate/release never reach the global allocator. Blocks never move.
+class PoolArena {
+public:
+    PoolArena(size_t blockSize, size_t blockAlignment, size_t blocksPerChunk = 64)
+        : blockSize(roundUp(std::max(blockSize, sizeof(FreeBlock)), std::max(blockAlignment, alignof(FreeBlock)))),
+        blockAlignment(std::max(blockAlignment, alignof(FreeBlock))), blocksPerChunk(blocksPerChunk) {
+    }
+
+    // Every block must have been released (the objects in it destroyed) by now
+    virtual ~PoolArena() {
+        for (void *chunk : chunks) {
+            ::operator delete(chunk, std::align_val_t(blockAlignment));
+        }
+    }
+
+    PoolArena(const PoolArena &) = delete;
+    PoolArena &operator=(const PoolArena &) = delete;
+
+    void *allocate() {
+        if (!freeList) {
+            addChunk();
+        }
+        FreeBlock *block = freeList;
+        freeList = block->next;
+        liveBlocks++;
+        return block;
+    }
+
+    void release(void *memory) {
+        FreeBlock *block = static_cast<FreeBlock *>(memory);
+        block->next = freeList;
+        freeList = block;
+        liveBlocks--;
+    }
+
+    // Makes room for count live blocks in total
+    void reserve(size_t count) {
+        while (capacity() < count) {
+            addChunk();
+        }
+    }
+
+    size_t size() const { return liveBlocks; }
+    size_t capacity() const { return chunks.size() * blocksPerChunk; }
+
+private:
+    struct FreeBlock {
+        FreeBlock *next;
+    };
+
+    size_t blockSize;
+    size_t blockAlignment;
+    size_t blocksPerChunk;
+    std::vector<void *> chunks;
+    FreeBlock *freeList = nullptr;
+    size_t liveBlocks = 0;
+
+    static size_t roundUp(size_t value, size_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    void addChunk() {
+        unsigned char *chunk = static_cast<unsigned char *>(::operator new(blockSize * blocksPerChunk, std::align_val_t(blockAlignment)));
+        chunks.push_back(chunk);
+        // Thread the new blocks onto the free list, lowest address first
+        for (size_t i = blocksPerChunk; i-- > 0;) {
+            FreeBlock *block = reinterpret_cast<FreeBlock *>(chunk + i * blockSize);
+            block->next = freeList;
+            freeList = block;
+        }
+    }
+};
+
+// Deleter of a PoolPtr: gives the memory back to the arena it came from, or uses delete for
+// objects made with new/make_unique, so both kinds can sit in the same containers.
+// Converts like default_delete, so PoolPtr<Button> moves into PoolPtr<GameObject>.
+template <typename T>
+struct PoolDeleter {
+    PoolArena *arena = nullptr;
+
+    PoolDeleter() = default;
+    explicit PoolDeleter(PoolArena *arena) : arena(arena) {}
+    template <typename U, typename = std::enable_if_t<std::is_convertible<U *, T *>::value>>
+    PoolDeleter(const PoolDeleter<U> &other) : arena(other.arena) {}
+    template <typename U, typename = std::enable_if_t<std::is_convertible<U *, T *>::value>>
+    PoolDeleter(const std::default_delete<U> &) {}
+
+    void operator()(T *object) const {
+        if (!arena) {
+            delete object;
+            return;
+        }
+        // The block starts at the most derived object, which a base pointer may not
+        void *block = mostDerived(object);
+        object->~T();
+        arena->release(block);
+    }
+
+private:
+    static void *mostDerived(T *object) {
+        if constexpr (std::is_polymorphic<T>::value) {
+            return dynamic_cast<void *>(object);
+        } else {
+            return object;
+        }
+    }
+};
+
+template <typename T>
+using PoolPtr = std::unique_ptr<T, PoolDeleter<T>>;
+
+// Typed arena for T
+template <typename T>
+class ObjectPool : public PoolArena {
+public:
+    explicit ObjectPool(size_t blocksPerChunk = 64) : PoolArena(sizeof(T), alignof(T), blocksPerChunk) {}
+
+    template <typename... Args>
+    PoolPtr<T> create(Args &&...args) {
+        return PoolPtr<T>(new (allocate()) T(std::forward<Args>(args)...), PoolDeleter<T>(this));
+    }
+};
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "Collider.h"
+
+#include <vector>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+// Structure-of-arrays storage for the per-body data read by the collision pipeline.
+// Index i always matches PhysicsSystem's i-th body. World OBBs live here; velocities,
+// masks and flags are mirrored from the RigidBody at the start of every step so the
+// hot loops never have to chase GameObject/RigidBody pointers.
+struct PhysicsBodyStore {
+    enum Flags : uint8_t {
+        FlagStatic = 1 << 0,
+        FlagSleeping = 1 << 1,
+        FlagCollisionEnabled = 1 << 2,
+        FlagHasCollider = 1 << 3,
+    };
+
+    // World OBB
+    std::vector<glm::vec3> centers;
+    std::vector<glm::vec3> axes[3];
+    std::vector<glm::vec3> halfExtents;
+
+    // Mirrored body state
+    std::vector<glm::vec3> velocities;
+    std::vector<uint32_t> masks;
+    std::vector<uint8_t> flags;
+
+    size_t size() const { return centers.size(); }
+
+    void push() {
+        centers.emplace_back(0.0f);
+        for (auto &axis : axes) axis.emplace_back(0.0f);
+        halfExtents.emplace_back(0.0f);
+        velocities.emplace_back(0.0f);
+        masks.push_back(0);
+        flags.push_back(0);
+    }
+
+    void reserve(size_t count) {
+        centers.reserve(count);
+        for (auto &axis : axes) axis.reserve(count);
+        halfExtents.reserve(count);
+        velocities.reserve(count);
+        masks.reserve(count);
+        flags.reserve(count);
+    }
+
+    // Removes every body whose keep[i] is 0, preserving the order of the rest
+    void compact(const std::vector<uint8_t> &keep) {
+        size_t out = 0;
+        for (size_t i = 0; i < size(); ++i) {
+            if (!keep[i]) continue;
+            centers[out] = centers[i];
+            for (auto &axis : axes) axis[out] = axis[i];
+            halfExtents[out] = halfExtents[i];
+            velocities[out] = velocities[i];
+            masks[out] = masks[i];
+            flags[out] = flags[i];
+            out++;
+        }
+        centers.resize(out);
+        for (auto &axis : axes) axis.resize(out);
+        halfExtents.resize(out);
+        velocities.resize(out);
+        masks.resize(out);
+        flags.resize(out);
+    }
+
+    bool hasFlag(size_t i, uint8_t flag) const { return (flags[i] & flag) != 0; }
+    void setFlag(size_t i, uint8_t flag, bool value) {
+        flags[i] = value ? (flags[i] | flag) : (flags[i] & ~flag);
+    }
+
+    void setOBB(size_t i, const OBB &obb) {
+        centers[i] = obb.center;
+        axes[0][i] = obb.axes[0];
+        axes[1][i] = obb.axes[1];
+        axes[2][i] = obb.axes[2];
+        halfExtents[i] = obb.halfExtents;
+    }
+
+    OBB getOBB(size_t i) const {
+        glm::vec3 obbAxes[3] = { axes[0][i], axes[1][i], axes[2][i] };
+        return OBB(centers[i], obbAxes, halfExtents[i]);
+    }
+
+    AABB getBounds(size_t i) const {
+        glm::vec3 extent = glm::abs(axes[0][i]) * halfExtents[i].x +
+            glm::abs(axes[1][i]) * halfExtents[i].y +
+            glm::abs(axes[2][i]) * halfExtents[i].z;
+        return AABB(centers[i] - extent, centers[i] + extent);
+    }
+};
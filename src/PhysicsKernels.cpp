@@ -0,0 +1,350 @@
+#include "PhysicsKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if PORTAL_PHYSICS_SSE
+#include <emmintrin.h>
+#endif
+
+// Added to |R| so cross products of near-parallel edges cannot produce a false separation
+constexpr float SAT_EPSILON = 1e-5f;
+// Ray directions closer to parallel than this are treated as parallel to the slab
+constexpr float RAY_PARALLEL_EPSILON = 1e-6f;
+// Squared length below which a swept SAT cross product axis is skipped
+constexpr float SWEEP_AXIS_EPSILON = 1e-6f;
+
+void gatherOBBBatch(const PhysicsBodyStore &store, const int *indices, int count, OBBBatch &out) {
+    out.count = count;
+    for (int lane = 0; lane < OBB_BATCH_WIDTH; ++lane) {
+        int index = indices[lane < count ? lane : 0];
+        const glm::vec3 &c = store.centers[index];
+        const glm::vec3 &h = store.halfExtents[index];
+        for (int k = 0; k < 3; ++k) {
+            out.center[k][lane] = c[k];
+            out.halfExtents[k][lane] = h[k];
+        }
+        for (int axis = 0; axis < 3; ++axis) {
+            const glm::vec3 &v = store.axes[axis][index];
+            out.axes[axis][0][lane] = v.x;
+            out.axes[axis][1][lane] = v.y;
+            out.axes[axis][2][lane] = v.z;
+        }
+    }
+}
+
+bool overlapOBB(const OBB &a, const OBB &b) {
+    // Separating axis test in A's frame (Ericson, Real-Time Collision Detection 4.4.1)
+    float R[3][3], AbsR[3][3];
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            R[i][j] = glm::dot(a.axes[i], b.axes[j]);
+            AbsR[i][j] = std::abs(R[i][j]) + SAT_EPSILON;
+        }
+    }
+
+    glm::vec3 T = b.center - a.center;
+    float t[3] = { glm::dot(T, a.axes[0]), glm::dot(T, a.axes[1]), glm::dot(T, a.axes[2]) };
+    const glm::vec3 &ha = a.halfExtents;
+    const glm::vec3 &hb = b.halfExtents;
+
+    for (int i = 0; i < 3; ++i) {
+        float ra = ha[i];
+        float rb = hb[0] * AbsR[i][0] + hb[1] * AbsR[i][1] + hb[2] * AbsR[i][2];
+        if (std::abs(t[i]) > ra + rb) return false;
+    }
+
+    for (int j = 0; j < 3; ++j) {
+        float ra = ha[0] * AbsR[0][j] + ha[1] * AbsR[1][j] + ha[2] * AbsR[2][j];
+        float rb = hb[j];
+        if (std::abs(t[0] * R[0][j] + t[1] * R[1][j] + t[2] * R[2][j]) > ra + rb) return false;
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+        for (int j = 0; j < 3; ++j) {
+            int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+            float ra = ha[i1] * AbsR[i2][j] + ha[i2] * AbsR[i1][j];
+            float rb = hb[j1] * AbsR[i][j2] + hb[j2] * AbsR[i][j1];
+            if (std::abs(t[i2] * R[i1][j] - t[i1] * R[i2][j]) > ra + rb) return false;
+        }
+    }
+
+    return true;
+}
+
+float intersectRayOBB(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance, const OBB &obb) {
+    // Transform ray to OBB local space
+    glm::vec3 p = obb.center - origin;
+
+    glm::vec3 f(
+        glm::dot(obb.axes[0], direction),
+        glm::dot(obb.axes[1], direction),
+        glm::dot(obb.axes[2], direction)
+    );
+
+    glm::vec3 e(
+        glm::dot(obb.axes[0], p),
+        glm::dot(obb.axes[1], p),
+        glm::dot(obb.axes[2], p)
+    );
+
+    // Test against 3 pairs of planes
+    float tmin = 0.0f;
+    float tmax = maxDistance;
+
+    for (int i = 0; i < 3; i++) {
+        float r = obb.halfExtents[i];
+        if (std::abs(f[i]) > RAY_PARALLEL_EPSILON) {
+            float t1 = (e[i] + r) / f[i];
+            float t2 = (e[i] - r) / f[i];
+            if (t1 > t2) std::swap(t1, t2);
+            if (t1 > tmin) tmin = t1;
+            if (t2 < tmax) tmax = t2;
+            if (tmin > tmax) return -1.0f;
+            if (tmax < 0) return -1.0f;
+        } else if (-e[i] - r > 0 || -e[i] + r < 0) {
+            return -1.0f;
+        }
+    }
+
+    // Rays starting inside the box do not report it
+    if (tmin > 0) return tmin;
+    return -1.0f;
+}
+
+SweepResult sweepOBB(const OBB &moving, const glm::vec3 &displacement, const OBB &obb) {
+    // Swept SAT: on every axis the projections overlap during one time interval; the boxes touch
+    // when all intervals overlap. The axis entered last gives the contact normal.
+    SweepResult result;
+    float tEnter = -std::numeric_limits<float>::max();
+    float tExit = std::numeric_limits<float>::max();
+    float minPenetration = std::numeric_limits<float>::max();
+    glm::vec3 enterNormal(0.0f);
+    glm::vec3 overlapNormal(0.0f);
+    glm::vec3 separation = obb.center - moving.center;
+
+    auto testAxis = [&](glm::vec3 axis) {
+        float lengthSq = glm::dot(axis, axis);
+        if (lengthSq < SWEEP_AXIS_EPSILON) return true; // Parallel edges, covered by the face axes
+        axis /= std::sqrt(lengthSq);
+
+        float radius = 0.0f;
+        for (int i = 0; i < 3; ++i) {
+            radius += std::abs(glm::dot(moving.axes[i], axis)) * moving.halfExtents[i];
+            radius += std::abs(glm::dot(obb.axes[i], axis)) * obb.halfExtents[i];
+        }
+        float distance = glm::dot(separation, axis);
+        float speed = glm::dot(displacement, axis);
+        // Normal pointing from the obstacle towards the moving box
+        glm::vec3 normal = distance > 0.0f ? -axis : axis;
+
+        float penetration = radius - std::abs(distance);
+        if (penetration < minPenetration) {
+            minPenetration = penetration;
+            overlapNormal = normal;
+        }
+
+        if (std::abs(speed) < RAY_PARALLEL_EPSILON) {
+            // Not moving along this axis: separated for the whole sweep or never
+            return penetration > 0.0f;
+        }
+        float t1 = (distance - radius) / speed;
+        float t2 = (distance + radius) / speed;
+        if (t1 > t2) std::swap(t1, t2);
+        if (t1 > tEnter) {
+            tEnter = t1;
+            enterNormal = speed > 0.0f ? -axis : axis;
+        }
+        tExit = std::min(tExit, t2);
+        return tEnter <= tExit && tExit >= 0.0f && tEnter <= 1.0f;
+        };
+
+    for (int i = 0; i < 3; ++i) {
+        if (!testAxis(moving.axes[i])) return result;
+    }
+    for (int i = 0; i < 3; ++i) {
+        if (!testAxis(obb.axes[i])) return result;
+    }
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            if (!testAxis(glm::cross(moving.axes[i], obb.axes[j]))) return result;
+        }
+    }
+
+    if (minPenetration > 0.0f) {
+        // Already overlapping at the start
+        result.overlapping = true;
+        result.normal = overlapNormal;
+        result.penetration = minPenetration;
+        return result;
+    }
+    result.hit = true;
+    result.time = std::max(tEnter, 0.0f);
+    result.normal = enterNormal;
+    return result;
+}
+
+#if PORTAL_PHYSICS_SSE
+
+namespace {
+
+inline __m128 abs4(__m128 v) {
+    return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+
+inline __m128 select4(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+inline __m128 dot4(const __m128 a[3], const __m128 b[3]) {
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], b[0]), _mm_mul_ps(a[1], b[1])), _mm_mul_ps(a[2], b[2]));
+}
+
+inline int laneMask(int count) {
+    return (1 << count) - 1;
+}
+
+}
+
+int overlapOBBBatch(const OBB &a, const OBBBatch &batch) {
+    const __m128 eps = _mm_set1_ps(SAT_EPSILON);
+
+    __m128 A[3][3]; // A's axes broadcast to all lanes
+    __m128 B[3][3];
+    for (int i = 0; i < 3; ++i) {
+        for (int k = 0; k < 3; ++k) {
+            A[i][k] = _mm_set1_ps(a.axes[i][k]);
+            B[i][k] = _mm_load_ps(batch.axes[i][k]);
+        }
+    }
+
+    __m128 T[3];
+    for (int k = 0; k < 3; ++k) {
+        T[k] = _mm_sub_ps(_mm_load_ps(batch.center[k]), _mm_set1_ps(a.center[k]));
+    }
+
+    __m128 t[3], R[3][3], AbsR[3][3];
+    for (int i = 0; i < 3; ++i) {
+        t[i] = dot4(T, A[i]);
+        for (int j = 0; j < 3; ++j) {
+            R[i][j] = dot4(A[i], B[j]);
+            AbsR[i][j] = _mm_add_ps(abs4(R[i][j]), eps);
+        }
+    }
+
+    __m128 ha[3], hb[3];
+    for (int k = 0; k < 3; ++k) {
+        ha[k] = _mm_set1_ps(a.halfExtents[k]);
+        hb[k] = _mm_load_ps(batch.halfExtents[k]);
+    }
+
+    const int lanes = laneMask(batch.count);
+    __m128 separated = _mm_setzero_ps();
+
+    // Face axes of A
+    for (int i = 0; i < 3; ++i) {
+        __m128 rb = _mm_add_ps(_mm_add_ps(_mm_mul_ps(hb[0], AbsR[i][0]), _mm_mul_ps(hb[1], AbsR[i][1])), _mm_mul_ps(hb[2], AbsR[i][2]));
+        separated = _mm_or_ps(separated, _mm_cmpgt_ps(abs4(t[i]), _mm_add_ps(ha[i], rb)));
+    }
+    if ((_mm_movemask_ps(separated) & lanes) == lanes) return 0;
+
+    // Face axes of B
+    for (int j = 0; j < 3; ++j) {
+        __m128 ra = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ha[0], AbsR[0][j]), _mm_mul_ps(ha[1], AbsR[1][j])), _mm_mul_ps(ha[2], AbsR[2][j]));
+        __m128 dist = _mm_add_ps(_mm_add_ps(_mm_mul_ps(t[0], R[0][j]), _mm_mul_ps(t[1], R[1][j])), _mm_mul_ps(t[2], R[2][j]));
+        separated = _mm_or_ps(separated, _mm_cmpgt_ps(abs4(dist), _mm_add_ps(ra, hb[j])));
+    }
+    if ((_mm_movemask_ps(separated) & lanes) == lanes) return 0;
+
+    // Edge-edge axes
+    for (int i = 0; i < 3; ++i) {
+        int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+        for (int j = 0; j < 3; ++j) {
+            int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+            __m128 ra = _mm_add_ps(_mm_mul_ps(ha[i1], AbsR[i2][j]), _mm_mul_ps(ha[i2], AbsR[i1][j]));
+            __m128 rb = _mm_add_ps(_mm_mul_ps(hb[j1], AbsR[i][j2]), _mm_mul_ps(hb[j2], AbsR[i][j1]));
+            __m128 dist = _mm_sub_ps(_mm_mul_ps(t[i2], R[i1][j]), _mm_mul_ps(t[i1], R[i2][j]));
+            separated = _mm_or_ps(separated, _mm_cmpgt_ps(abs4(dist), _mm_add_ps(ra, rb)));
+        }
+    }
+
+    return ~_mm_movemask_ps(separated) & lanes;
+}
+
+int raycastOBBBatch(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance, const OBBBatch &batch, float tOut[OBB_BATCH_WIDTH]) {
+    __m128 d[3], p[3];
+    for (int k = 0; k < 3; ++k) {
+        d[k] = _mm_set1_ps(direction[k]);
+        p[k] = _mm_sub_ps(_mm_load_ps(batch.center[k]), _mm_set1_ps(origin[k]));
+    }
+
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 parallelEps = _mm_set1_ps(RAY_PARALLEL_EPSILON);
+    __m128 tmin = zero;
+    __m128 tmax = _mm_set1_ps(maxDistance);
+    __m128 miss = zero;
+
+    for (int i = 0; i < 3; ++i) {
+        __m128 axis[3] = { _mm_load_ps(batch.axes[i][0]), _mm_load_ps(batch.axes[i][1]), _mm_load_ps(batch.axes[i][2]) };
+        __m128 f = dot4(axis, d);
+        __m128 e = dot4(axis, p);
+        __m128 r = _mm_load_ps(batch.halfExtents[i]);
+
+        __m128 parallel = _mm_cmple_ps(abs4(f), parallelEps);
+        __m128 t1 = _mm_div_ps(_mm_add_ps(e, r), f);
+        __m128 t2 = _mm_div_ps(_mm_sub_ps(e, r), f);
+        __m128 tNear = _mm_min_ps(t1, t2);
+        __m128 tFar = _mm_max_ps(t1, t2);
+
+        tmin = select4(parallel, tmin, _mm_max_ps(tmin, tNear));
+        tmax = select4(parallel, tmax, _mm_min_ps(tmax, tFar));
+
+        // Parallel to this slab: miss unless the origin lies between the planes
+        __m128 outside = _mm_or_ps(_mm_cmplt_ps(e, _mm_sub_ps(zero, r)), _mm_cmpgt_ps(e, r));
+        miss = _mm_or_ps(miss, _mm_and_ps(parallel, outside));
+    }
+
+    __m128 hit = _mm_andnot_ps(miss, _mm_cmple_ps(tmin, tmax));
+    hit = _mm_and_ps(hit, _mm_cmpge_ps(tmax, zero));
+    hit = _mm_and_ps(hit, _mm_cmpgt_ps(tmin, zero));
+
+    _mm_storeu_ps(tOut, tmin);
+    return _mm_movemask_ps(hit) & laneMask(batch.count);
+}
+
+#else
+
+namespace {
+
+OBB laneOBB(const OBBBatch &batch, int lane) {
+    glm::vec3 axes[3];
+    for (int i = 0; i < 3; ++i) {
+        axes[i] = glm::vec3(batch.axes[i][0][lane], batch.axes[i][1][lane], batch.axes[i][2][lane]);
+    }
+    glm::vec3 center(batch.center[0][lane], batch.center[1][lane], batch.center[2][lane]);
+    glm::vec3 halfExtents(batch.halfExtents[0][lane], batch.halfExtents[1][lane], batch.halfExtents[2][lane]);
+    return OBB(center, axes, halfExtents);
+}
+
+}
+
+int overlapOBBBatch(const OBB &a, const OBBBatch &batch) {
+    int mask = 0;
+    for (int lane = 0; lane < batch.count; ++lane) {
+        if (overlapOBB(a, laneOBB(batch, lane))) mask |= 1 << lane;
+    }
+    return mask;
+}
+
+int raycastOBBBatch(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance, const OBBBatch &batch, float tOut[OBB_BATCH_WIDTH]) {
+    int mask = 0;
+    for (int lane = 0; lane < batch.count; ++lane) {
+        tOut[lane] = intersectRayOBB(origin, direction, maxDistance, laneOBB(batch, lane));
+        if (tOut[lane] > 0.0f) mask |= 1 << lane;
+    }
+    return mask;
+}
+
+#endif
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Collider.h"
+#include "PhysicsBodyStore.h"
+
+#include <glm/glm.hpp>
+
+// Batched collision kernels. With SSE2 available (all x86-64 targets) one OBB or ray is
+// tested against four OBBs per call; otherwise the same results come from a scalar loop.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PORTAL_PHYSICS_SSE 1
+#else
+#define PORTAL_PHYSICS_SSE 0
+#endif
+
+constexpr int OBB_BATCH_WIDTH = 4;
+
+// Four OBBs transposed into lanes, gathered from the body store
+struct alignas(16) OBBBatch {
+    float center[3][OBB_BATCH_WIDTH];
+    float axes[3][3][OBB_BATCH_WIDTH]; // [axis][component][lane]
+    float halfExtents[3][OBB_BATCH_WIDTH];
+    int count = 0;
+};
+
+// Unused lanes repeat the first body and are masked off in the results
+void gatherOBBBatch(const PhysicsBodyStore &store, const int *indices, int count, OBBBatch &out);
+
+// Boolean SAT over all 15 axes. Bit i of the result is set if lane i overlaps a.
+// Conservative for near-parallel edges, so a set bit still needs the full checkCollisionSAT.
+int overlapOBBBatch(const OBB &a, const OBBBatch &batch);
+
+// Ray vs four OBBs. Bit i is set if lane i is hit in (0, maxDistance]; tOut[i] holds the distance.
+int raycastOBBBatch(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance, const OBBBatch &batch, float tOut[OBB_BATCH_WIDTH]);
+
+struct SweepResult {
+    bool hit = false; // Touches during the sweep, at time (0..1 of the displacement)
+    bool overlapping = false; // Already overlapping at the start, by penetration
+    float time = 1.0f;
+    float penetration = 0.0f;
+    glm::vec3 normal = glm::vec3(0.0f); // Points from the obstacle towards the moving box
+};
+
+// Moves one OBB along displacement (without rotating) and reports the first contact with another OBB
+SweepResult sweepOBB(const OBB &moving, const glm::vec3 &displacement, const OBB &obb);
+
+// Scalar reference versions
+bool overlapOBB(const OBB &a, const OBB &b);
+// Returns the entry distance, or a negative value on a miss. Rays starting inside the box miss it.
+float intersectRayOBB(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance, const OBB &obb);
@@ -1,13 +1,41 @@
 #include "PhysicsSystem.h"
 #include "GameObject.h"
+#include "PhysicsKernels.h"
 
 #include <algorithm>
 #include <iostream>
 
 #include <glm/gtx/norm.hpp>
 
-
-PhysicsSystem::PhysicsSystem() : gravity(glm::vec3(0.0f, -9.81f, 0.0f)) {}
+// Margin used to fatten broadphase proxies so resting and slow bodies are not re-inserted every step
+constexpr float BROADPHASE_MARGIN = 0.1f;
+// Contacts whose normal is steeper than this count as standing on the other body (about 45 degrees)
+constexpr float GROUND_NORMAL_MIN_Y = 0.7f;
+// Bodies slower than this for SLEEP_TIME seconds are candidates for sleeping
+constexpr float SLEEP_LINEAR_VELOCITY = 0.05f;
+constexpr float SLEEP_TIME = 0.5f;
+// Air resistance per second. Friction against other bodies is left to the contact solver.
+constexpr float AIR_DAMPING = 0.05f;
+// Contact solver: penetration left in place so resting contacts persist, fraction of the rest
+// corrected per step, and the approach speed below which contacts do not bounce
+constexpr float CONTACT_SLOP = 0.005f;
+constexpr float CONTACT_CORRECTION = 0.8f;
+constexpr float RESTITUTION_THRESHOLD = 0.5f;
+constexpr int POSITION_ITERATIONS = 4;
+// Manifolds keep their impulse while the normal stays within about 18 degrees
+constexpr float WARM_START_MIN_NORMAL_DOT = 0.95f;
+// A resting manifold is reused without SAT while its bodies moved less than this relative to each other
+constexpr float MANIFOLD_REUSE_DISTANCE = 0.01f;
+// Character sweeps: gap kept to obstacles, slide passes per move, and moves too small to bother with
+constexpr float CHARACTER_SKIN = 0.001f;
+constexpr int CHARACTER_SLIDE_ITERATIONS = 4;
+constexpr float CHARACTER_MIN_MOVE = 1e-5f;
+// Work per job: bodies for integration, runs of pairs sharing a body for the narrowphase
+constexpr size_t INTEGRATION_GRAIN_SIZE = 256;
+constexpr size_t NARROWPHASE_GRAIN_SIZE = 64;
+
+PhysicsSystem::PhysicsSystem(unsigned workerThreads)
+    : gravity(glm::vec3(0.0f, -9.81f, 0.0f)), staticBroadphase(BROADPHASE_MARGIN), dynamicBroadphase(BROADPHASE_MARGIN), jobs(workerThreads) {}
 
 PhysicsSystem::~PhysicsSystem() {}
 
@@ -20,67 +48,413 @@ void PhysicsSystem::addObject(GameObject *obj, RigidBody *rb, AABB *col) {
     physObj.gameObject = obj;
     physObj.rigidBody = rb;
     physObj.collider = col;
+    physObj.bodyId = nextBodyId++;
     physicsObjects.push_back(physObj);
+    bodies.push();
+    raycastTreesDirty = true;
+}
+
+void PhysicsSystem::reserve(size_t bodyCount) {
+    physicsObjects.reserve(bodyCount);
+    bodies.reserve(bodyCount);
+    dynamicBroadphase.reserve(static_cast<int>(bodyCount));
+    bodyMoved.reserve(bodyCount);
+    keptBodies.reserve(bodyCount);
+    positionShifts.reserve(bodyCount);
+    groundContacts.reserve(bodyCount);
+    islandParents.reserve(bodyCount);
+    islandCanSleep.reserve(bodyCount);
+    islandIds.reserve(bodyCount);
+    islandRemap.reserve(bodyCount);
 }
 
 void PhysicsSystem::removeObject(GameObject *obj) {
+    for (auto &pObj : physicsObjects) {
+        if (pObj.gameObject == obj && pObj.proxyId != DynamicAABBTree::NullNode) {
+            broadphaseFor(pObj).destroyProxy(pObj.proxyId);
+            pObj.proxyId = DynamicAABBTree::NullNode;
+        }
+    }
+    keptBodies.resize(physicsObjects.size());
+    for (size_t i = 0; i < physicsObjects.size(); ++i) {
+        keptBodies[i] = physicsObjects[i].gameObject != obj;
+    }
+    bodies.compact(keptBodies);
+    remapIslandMembers();
     physicsObjects.erase(std::remove_if(physicsObjects.begin(), physicsObjects.end(),
         [obj](const PhysicsObject &pObj) { return pObj.gameObject == obj; }), physicsObjects.end());
+
+    // Proxies store the body index, which shifted after the erase
+    for (size_t i = 0; i < physicsObjects.size(); ++i) {
+        if (physicsObjects[i].proxyId != DynamicAABBTree::NullNode) {
+            broadphaseFor(physicsObjects[i]).setUserData(physicsObjects[i].proxyId, static_cast<int>(i));
+        }
+    }
+    raycastTreesDirty = true;
+}
+
+void PhysicsSystem::resetContacts() {
+    manifolds.clear();
+    activeManifolds.clear();
+    raycastTreesDirty = true;
 }
 
 void PhysicsSystem::update(float dt) {
-    // Ground detection
+    // 0. Bodies woken from outside (forces, teleports) take their whole island with them
+    wakeTouchedIslands();
+    syncBodyState();
+
+    // 1. Integration and OBB refresh, every body is independent so this runs in parallel
+    bodyMoved.assign(physicsObjects.size(), 0);
+    jobs.parallelFor(physicsObjects.size(), INTEGRATION_GRAIN_SIZE, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            integrateBody(i, dt);
+        }
+        });
+
+    movedStaticBodies.clear();
+    for (size_t i = 0; i < bodyMoved.size(); ++i) {
+        if (bodyMoved[i] == BodyIntegrated) {
+            dynamicTreeMoved = true;
+        } else if (bodyMoved[i] == BodyStaticMoved) {
+            movedStaticBodies.push_back(static_cast<int>(i));
+            staticTreeMoved = true;
+        }
+    }
+    updateRaycastTrees();
+
+    // 2. Collision Detection & Resolution
+    updateBroadphase(dt);
+    wakeBodiesNearMovedStatics();
+    checkCollisions();
+
+    // 3. Ground detection, using this step's contacts and OBBs
+    updateGroundState();
+
+    // 4. Put settled islands to sleep
+    updateSleeping(dt);
+}
+
+void PhysicsSystem::integrateBody(size_t i, float dt) {
+    PhysicsObject &obj = physicsObjects[i];
+
+    // Sleeping bodies keep their pose and cached OBB
+    if (obj.rigidBody && obj.rigidBody->isSleeping) return;
+
+    if (obj.rigidBody && !obj.rigidBody->isStatic) {
+        integrate(obj, dt);
+        bodies.velocities[i] = obj.rigidBody->velocity;
+        bodyMoved[i] = BodyIntegrated;
+    }
+
+    // Update World OBB
+    if (obj.collider && obj.gameObject) {
+        const Transform &transform = obj.gameObject->getTransform();
+
+        // Static bodies only need a new OBB when their transform was rebuilt
+        bool moved = transform.getVersion() != obj.transformVersion;
+        obj.transformVersion = transform.getVersion();
+        if (obj.rigidBody->isStatic) {
+            if (!moved) return;
+            bodyMoved[i] = BodyStaticMoved;
+        }
+
+        updateBodyOBB(i);
+    }
+}
+
+void PhysicsSystem::updateBodyOBB(size_t i) {
+    const PhysicsObject &obj = physicsObjects[i];
+    const glm::mat3 &basis = obj.gameObject->getTransform().getBasis();
+    glm::vec3 axes[3] = { basis[0], basis[1], basis[2] }; // Right, Up, Forward
+
+    // Calculate center and half extents
+    glm::vec3 localCenter = (obj.collider->min + obj.collider->max) * 0.5f;
+    glm::vec3 localExtent = (obj.collider->max - obj.collider->min) * 0.5f;
+
+    // Apply scale
+    glm::vec3 scaledExtent = localExtent * obj.gameObject->scale;
+
+    // Transform center to world space
+    // Note: We need to rotate the local center offset first, then add to position
+    glm::vec3 worldCenter = obj.gameObject->position + basis * (localCenter * obj.gameObject->scale);
+
+    bodies.setOBB(i, OBB(worldCenter, axes, scaledExtent));
+}
+
+void PhysicsSystem::syncBodyMasks() {
+    // Game code changes masks between steps (portal surfaces), character queries must see that
+    for (size_t i = 0; i < physicsObjects.size(); ++i) {
+        bodies.masks[i] = physicsObjects[i].rigidBody->collisionMask;
+    }
+}
+
+void PhysicsSystem::syncBodyState() {
+    for (size_t i = 0; i < physicsObjects.size(); ++i) {
+        const PhysicsObject &obj = physicsObjects[i];
+        const RigidBody *rb = obj.rigidBody;
+        uint8_t flags = 0;
+        if (rb->isStatic) flags |= PhysicsBodyStore::FlagStatic;
+        if (rb->isSleeping) flags |= PhysicsBodyStore::FlagSleeping;
+        if (rb->isCollisionEnabled) flags |= PhysicsBodyStore::FlagCollisionEnabled;
+        if (obj.collider && obj.gameObject) flags |= PhysicsBodyStore::FlagHasCollider;
+        bodies.flags[i] = flags;
+        bodies.masks[i] = rb->collisionMask;
+        bodies.velocities[i] = rb->velocity;
+    }
+}
+
+void PhysicsSystem::wakeIsland(int islandId) {
+    auto island = islandMembers.find(islandId);
+    if (island == islandMembers.end()) return;
+    for (int i : island->second) {
+        PhysicsObject &obj = physicsObjects[i];
+        RigidBody *rb = obj.rigidBody;
+        if (!rb || rb->islandId != islandId) continue;
+        if (rb->isSleeping) {
+            rb->wake();
+            bodies.setFlag(i, PhysicsBodyStore::FlagSleeping, false);
+        }
+        obj.wasSleeping = false;
+    }
+    // Every member is awake now; if they settle again they get a new island
+    islandMembers.erase(island);
+}
+
+void PhysicsSystem::remapIslandMembers() {
+    // keptBodies marks the bodies that survive a removal, the others shift down over the gaps
+    islandRemap.resize(keptBodies.size());
+    int next = 0;
+    for (size_t i = 0; i < keptBodies.size(); ++i) {
+        islandRemap[i] = keptBodies[i] ? next++ : -1;
+    }
+    for (auto island = islandMembers.begin(); island != islandMembers.end();) {
+        std::vector<int> &members = island->second;
+        size_t out = 0;
+        for (int index : members) {
+            if (islandRemap[index] >= 0) members[out++] = islandRemap[index];
+        }
+        members.resize(out);
+        island = members.empty() ? islandMembers.erase(island) : std::next(island);
+    }
+}
+
+void PhysicsSystem::wakeTouchedIslands() {
     for (auto &obj : physicsObjects) {
-        if (obj.rigidBody && !obj.rigidBody->isStatic && obj.collider) {
-            // Raycast downward to detect ground
-            glm::vec3 rayOrigin = obj.gameObject->position;
-            glm::vec3 rayDirection = glm::vec3(0.0f, -1.0f, 0.0f); // Down
-            float rayLength = (obj.collider->max.y - obj.collider->min.y) * obj.gameObject->scale.y + 0.1f; // Slightly more than collider height
-            RaycastHit hit = raycast(rayOrigin, rayDirection, rayLength);
-            obj.rigidBody->isOnGround = hit.hit;
-        } else {
-            obj.rigidBody->isOnGround = false;
+        if (obj.wasSleeping && obj.rigidBody && !obj.rigidBody->isSleeping) {
+            wakeIsland(obj.rigidBody->islandId);
         }
     }
+}
+
+void PhysicsSystem::wakeBodiesNearMovedStatics() {
+    // A static body that moved (flip wall, portal frame) may have pulled the floor out from under something
+    for (int index : movedStaticBodies) {
+        AABB bounds = bodies.getBounds(index);
+        dynamicBroadphase.query(bounds, [&](int proxyId) {
+            int other = dynamicBroadphase.getUserData(proxyId);
+            if (bodies.hasFlag(other, PhysicsBodyStore::FlagSleeping)) {
+                wakeIsland(physicsObjects[other].rigidBody->islandId);
+            }
+            return true;
+            });
+    }
+}
+
+int PhysicsSystem::findIslandRoot(int index) {
+    while (islandParents[index] != index) {
+        islandParents[index] = islandParents[islandParents[index]];
+        index = islandParents[index];
+    }
+    return index;
+}
+
+void PhysicsSystem::updateSleeping(float dt) {
+    size_t count = physicsObjects.size();
 
-    // 1. Integration
+    // Per-body rest timers
     for (auto &obj : physicsObjects) {
-        if (obj.rigidBody && !obj.rigidBody->isStatic) {
-            integrate(obj, dt);
+        RigidBody *rb = obj.rigidBody;
+        if (!rb || rb->isStatic || rb->isSleeping) continue;
+        if (glm::length2(rb->velocity) < SLEEP_LINEAR_VELOCITY * SLEEP_LINEAR_VELOCITY) {
+            rb->sleepTimer += dt;
+        } else {
+            rb->sleepTimer = 0.0f;
+        }
+    }
+
+    // Group awake dynamic bodies that touch into islands. Static bodies do not link islands.
+    islandParents.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        islandParents[i] = static_cast<int>(i);
+    }
+    for (const auto &pair : islandContacts) {
+        int rootA = findIslandRoot(pair.first);
+        int rootB = findIslandRoot(pair.second);
+        if (rootA != rootB) islandParents[rootB] = rootA;
+    }
+
+    // An island sleeps only when every body in it has been resting long enough
+    islandCanSleep.assign(count, 1);
+    for (size_t i = 0; i < count; ++i) {
+        RigidBody *rb = physicsObjects[i].rigidBody;
+        if (!rb || rb->isStatic || rb->isSleeping) continue;
+        if (rb->sleepTimer < SLEEP_TIME) islandCanSleep[findIslandRoot(static_cast<int>(i))] = 0;
+    }
+
+    islandIds.assign(count, -1);
+    stats.sleepingBodies = 0;
+    for (size_t i = 0; i < count; ++i) {
+        PhysicsObject &obj = physicsObjects[i];
+        RigidBody *rb = obj.rigidBody;
+        if (rb && rb->isSleeping) {
+            stats.sleepingBodies++;
+            continue;
         }
+        if (!rb || rb->isStatic) continue;
+
+        int root = findIslandRoot(static_cast<int>(i));
+        if (!islandCanSleep[root]) continue;
+
+        if (islandIds[root] < 0) islandIds[root] = nextIslandId++;
+        rb->isSleeping = true;
+        rb->islandId = islandIds[root];
+        islandMembers[rb->islandId].push_back(static_cast<int>(i));
+        bodies.setFlag(i, PhysicsBodyStore::FlagSleeping, true);
+        rb->velocity = glm::vec3(0.0f);
+        rb->clearForces();
+        obj.wasSleeping = true;
+        stats.sleepingBodies++;
+    }
+}
 
-        // Update World OBB
-        if (obj.collider && obj.gameObject) {
-            // Calculate rotation matrix from Euler angles
-            glm::mat4 rotationMat = glm::mat4(1.0f);
-            rotationMat = glm::rotate(rotationMat, glm::radians(obj.gameObject->rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-            rotationMat = glm::rotate(rotationMat, glm::radians(obj.gameObject->rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-            rotationMat = glm::rotate(rotationMat, glm::radians(obj.gameObject->rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
-
-            // Extract axes
-            glm::vec3 axes[3];
-            axes[0] = glm::vec3(rotationMat[0]); // Right
-            axes[1] = glm::vec3(rotationMat[1]); // Up
-            axes[2] = glm::vec3(rotationMat[2]); // Forward
-
-            // Calculate center and half extents
-            glm::vec3 localCenter = (obj.collider->min + obj.collider->max) * 0.5f;
-            glm::vec3 localExtent = (obj.collider->max - obj.collider->min) * 0.5f;
-
-            // Apply scale
-            glm::vec3 scaledExtent = localExtent * obj.gameObject->scale;
-
-            // Transform center to world space
-            // Note: We need to rotate the local center offset first, then add to position
-            glm::vec3 rotatedCenterOffset = glm::vec3(rotationMat * glm::vec4(localCenter * obj.gameObject->scale, 1.0f));
-            glm::vec3 worldCenter = obj.gameObject->position + rotatedCenterOffset;
-
-            obj.worldOBB = OBB(worldCenter, axes, scaledExtent);
+void PhysicsSystem::updateGroundState() {
+    // Bodies resting on something were already reported by narrowphase.
+    // Everything else gets a downward probe, gathered first and then tested in one pass.
+    groundProbes.clear();
+    for (size_t i = 0; i < physicsObjects.size(); ++i) {
+        PhysicsObject &obj = physicsObjects[i];
+        if (!obj.rigidBody || obj.rigidBody->isStatic || !obj.collider) {
+            if (obj.rigidBody) obj.rigidBody->isOnGround = false;
+            continue;
+        }
+        if (obj.rigidBody->isSleeping) continue; // Keeps the state it fell asleep with
+        if (groundContacts[i]) {
+            obj.rigidBody->isOnGround = true;
+            continue;
         }
+
+        GroundProbe probe;
+        probe.bodyIndex = static_cast<int>(i);
+        probe.origin = obj.gameObject->position;
+        probe.length = (obj.collider->max.y - obj.collider->min.y) * obj.gameObject->scale.y + 0.1f; // Slightly more than collider height
+        groundProbes.push_back(probe);
     }
 
-    // 2. Collision Detection & Resolution
-    checkCollisions();
+    const glm::vec3 down(0.0f, -1.0f, 0.0f);
+    for (const GroundProbe &probe : groundProbes) {
+        physicsObjects[probe.bodyIndex].rigidBody->isOnGround = raycastAny(probe.origin, down, probe.length);
+    }
+}
+
+void PhysicsSystem::updateBroadphase(float dt) {
+    for (size_t i = 0; i < physicsObjects.size(); ++i) {
+        uint8_t flags = bodies.flags[i];
+        if (!(flags & PhysicsBodyStore::FlagHasCollider)) continue;
+
+        PhysicsObject &obj = physicsObjects[i];
+        if ((flags & PhysicsBodyStore::FlagSleeping) && obj.proxyId != DynamicAABBTree::NullNode) continue;
+
+        AABB bounds = bodies.getBounds(i);
+        if (obj.proxyId == DynamicAABBTree::NullNode) {
+            obj.proxyId = broadphaseFor(obj).createProxy(bounds, static_cast<int>(i));
+        } else {
+            glm::vec3 displacement = (flags & PhysicsBodyStore::FlagStatic) ? glm::vec3(0.0f) : bodies.velocities[i] * dt;
+            broadphaseFor(obj).moveProxy(obj.proxyId, bounds, displacement);
+        }
+    }
+}
+
+void PhysicsSystem::prepareRaycastTrees() {
+    if (!raycastTreesDirty) return;
+    // Bodies were added, removed or restored since the last step (level swap, despawn, snapshot),
+    // and the player raycasts before the next step runs. Rebuild from the current poses. The
+    // transform versions are left alone so the next step still notices static bodies that moved.
+    syncBodyState();
+    for (size_t i = 0; i < physicsObjects.size(); ++i) {
+        if (physicsObjects[i].collider && physicsObjects[i].gameObject) updateBodyOBB(i);
+    }
+    updateRaycastTrees();
+}
+
+void PhysicsSystem::updateRaycastTrees() {
+    auto boundsOf = [this](int index) { return bodies.getBounds(index); };
+
+    if (raycastTreesDirty) {
+        std::vector<BVH::Primitive> staticPrims;
+        std::vector<BVH::Primitive> dynamicPrims;
+        for (size_t i = 0; i < physicsObjects.size(); ++i) {
+            if (!bodies.hasFlag(i, PhysicsBodyStore::FlagHasCollider)) continue;
+            BVH::Primitive prim{ bodies.getBounds(i), static_cast<int>(i) };
+            if (bodies.hasFlag(i, PhysicsBodyStore::FlagStatic)) {
+                staticPrims.push_back(prim);
+            } else {
+                dynamicPrims.push_back(prim);
+            }
+        }
+        staticTree.build(std::move(staticPrims));
+        dynamicTree.build(std::move(dynamicPrims));
+        raycastTreesDirty = false;
+        staticTreeMoved = false;
+        dynamicTreeMoved = false;
+        return;
+    }
+
+    if (staticTreeMoved) {
+        staticTree.refit(boundsOf);
+        staticTreeMoved = false;
+    }
+    // Skipped entirely when every dynamic body is asleep
+    if (dynamicTreeMoved) {
+        dynamicTree.refit(boundsOf);
+        dynamicTreeMoved = false;
+    }
+}
+
+void PhysicsSystem::findCandidatePairs() {
+    candidatePairs.clear();
+
+    // Only awake non-static bodies query the trees, so static-static and sleeping-sleeping
+    // pairs are never generated
+    const uint8_t inactive = PhysicsBodyStore::FlagStatic | PhysicsBodyStore::FlagSleeping;
+    for (size_t i = 0; i < physicsObjects.size(); ++i) {
+        if (physicsObjects[i].proxyId == DynamicAABBTree::NullNode) continue;
+        uint8_t flags = bodies.flags[i];
+        if ((flags & inactive) || !(flags & PhysicsBodyStore::FlagCollisionEnabled)) continue;
+
+        int self = static_cast<int>(i);
+        uint32_t mask = bodies.masks[i];
+        AABB bounds = bodies.getBounds(i);
+        auto addPair = [&](const DynamicAABBTree &tree, int proxyId) {
+            int other = tree.getUserData(proxyId);
+            if (other == self) return true;
+
+            uint8_t otherFlags = bodies.flags[other];
+            // Awake dynamic pairs are reported by both bodies; keep the one from the lower index.
+            // Sleeping bodies never query, so their pairs always come from the awake side.
+            if (!(otherFlags & inactive) && other < self) return true;
+            if (!(otherFlags & PhysicsBodyStore::FlagCollisionEnabled)) return true;
+            if ((mask & bodies.masks[other]) == 0) return true;
+
+            candidatePairs.emplace_back(std::min(self, other), std::max(self, other));
+            return true;
+            };
+        staticBroadphase.query(bounds, [&](int proxyId) { return addPair(staticBroadphase, proxyId); });
+        dynamicBroadphase.query(bounds, [&](int proxyId) { return addPair(dynamicBroadphase, proxyId); });
+    }
+
+    // Resolve in the same order as the old pairwise loop
+    std::sort(candidatePairs.begin(), candidatePairs.end());
 }
 
 void PhysicsSystem::integrate(PhysicsObject &obj, float dt) {
@@ -98,9 +472,8 @@ void PhysicsSystem::integrate(PhysicsObject &obj, float dt) {
     // v = v0 + at
     rb->velocity += acc * dt;
 
-    // Apply Damping/Friction
-    float dampingFactor = rb->isOnGround ? rb->friction : 0.05f; // Ground friction vs air resistance
-    rb->velocity *= (1.0f - dt * dampingFactor);
+    // Apply Damping
+    rb->velocity *= (1.0f - dt * AIR_DAMPING);
 
     rb->velocity.y = std::max(rb->velocity.y, -40.0f);
 
@@ -112,24 +485,228 @@ void PhysicsSystem::integrate(PhysicsObject &obj, float dt) {
 }
 
 void PhysicsSystem::checkCollisions() {
-    for (size_t i = 0; i < physicsObjects.size(); ++i) {
-        for (size_t j = i + 1; j < physicsObjects.size(); ++j) {
-            PhysicsObject &a = physicsObjects[i];
-            PhysicsObject &b = physicsObjects[j];
+    findCandidatePairs();
+    groundContacts.assign(physicsObjects.size(), 0);
+    islandContacts.clear();
+
+    stats.bodyCount = physicsObjects.size();
+    stats.candidatePairs = candidatePairs.size();
+    stats.narrowphaseTests = 0;
+    stats.contacts = 0;
+    stats.reusedContacts = 0;
+
+    // Pairs are sorted, so all pairs sharing a first body are adjacent. Each run is one job.
+    size_t pairCount = candidatePairs.size();
+    pairRuns.clear();
+    for (size_t i = 0; i < pairCount; ++i) {
+        if (i == 0 || candidatePairs[i].first != candidatePairs[i - 1].first) pairRuns.push_back(i);
+    }
+    pairRuns.push_back(pairCount);
+
+    // Contact generation only reads the OBBs, so it runs in parallel
+    contactResults.assign(pairCount, ContactResult());
+    jobs.parallelFor(pairRuns.size() - 1, NARROWPHASE_GRAIN_SIZE, [&](size_t begin, size_t end) {
+        for (size_t run = begin; run < end; ++run) {
+            narrowphaseRun(pairRuns[run], pairRuns[run + 1]);
+        }
+        });
+
+    // Contacts are turned into manifolds and solved on this thread in pair order.
+    // The result does not depend on how many workers computed the contacts.
+    manifoldStep++;
+    activeManifolds.clear();
+    for (size_t i = 0; i < pairCount; ++i) {
+        const ContactResult &result = contactResults[i];
+        if (result.tested) stats.narrowphaseTests++;
+        if (result.reused) stats.reusedContacts++;
+        if (!result.hit) continue;
+        stats.contacts++;
+
+        const std::pair<int, int> &pair = candidatePairs[i];
+        PhysicsObject &a = physicsObjects[pair.first];
+        PhysicsObject &b = physicsObjects[pair.second];
+
+        // Touching an awake body wakes a sleeping island
+        if (a.rigidBody->isSleeping) wakeIsland(a.rigidBody->islandId);
+        if (b.rigidBody->isSleeping) wakeIsland(b.rigidBody->islandId);
+        if (!a.rigidBody->isStatic && !b.rigidBody->isStatic) {
+            islandContacts.emplace_back(pair.first, pair.second);
+        }
+
+        // Normal points from B to A; an upward facing contact means the body is supported
+        if (result.normal.y > GROUND_NORMAL_MIN_Y) groundContacts[pair.first] = 1;
+        if (-result.normal.y > GROUND_NORMAL_MIN_Y) groundContacts[pair.second] = 1;
+
+        // Manifolds that were not touched last step are already gone, so an existing one persisted
+        auto inserted = manifolds.try_emplace(manifoldKey(a, b));
+        ContactManifold &manifold = inserted.first->second;
+        if (!inserted.second && glm::dot(manifold.normal, result.normal) < WARM_START_MIN_NORMAL_DOT) {
+            manifold.normalImpulse = 0.0f;
+            manifold.tangentImpulse = glm::vec3(0.0f);
+        }
+        manifold.bodyA = pair.first;
+        manifold.bodyB = pair.second;
+        manifold.normal = result.normal;
+        manifold.penetration = result.penetration;
+        manifold.lastStep = manifoldStep;
+        if (result.tested) {
+            // Fresh SAT result, later steps measure relative motion from here
+            manifold.hasReference = true;
+            manifold.referenceOffset = bodies.centers[pair.first] - bodies.centers[pair.second];
+            manifold.referencePenetration = result.penetration;
+            manifold.referenceAxes[0] = bodies.axes[0][pair.first];
+            manifold.referenceAxes[1] = bodies.axes[1][pair.first];
+            manifold.referenceAxes[2] = bodies.axes[0][pair.second];
+            manifold.referenceAxes[3] = bodies.axes[1][pair.second];
+        }
+        activeManifolds.push_back(&manifold);
+    }
+
+    // Pairs that stopped touching lose their manifold
+    for (auto it = manifolds.begin(); it != manifolds.end();) {
+        if (it->second.lastStep != manifoldStep) {
+            it = manifolds.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    solveContacts();
+}
+
+bool PhysicsSystem::reuseManifold(size_t pairIndex) {
+    const std::pair<int, int> &pair = candidatePairs[pairIndex];
+    auto it = manifolds.find(manifoldKey(physicsObjects[pair.first], physicsObjects[pair.second]));
+    if (it == manifolds.end()) return false;
+
+    const ContactManifold &manifold = it->second;
+    if (manifold.lastStep != manifoldStep || !manifold.hasReference) return false;
+
+    // Only valid while neither body rotated and they barely moved relative to each other
+    if (bodies.axes[0][pair.first] != manifold.referenceAxes[0] || bodies.axes[1][pair.first] != manifold.referenceAxes[1] ||
+        bodies.axes[0][pair.second] != manifold.referenceAxes[2] || bodies.axes[1][pair.second] != manifold.referenceAxes[3]) {
+        return false;
+    }
+    glm::vec3 delta = (bodies.centers[pair.first] - bodies.centers[pair.second]) - manifold.referenceOffset;
+    if (glm::length2(delta) > MANIFOLD_REUSE_DISTANCE * MANIFOLD_REUSE_DISTANCE) return false;
+
+    // Moving A along the normal (B to A) reduces the overlap
+    ContactResult &result = contactResults[pairIndex];
+    result.reused = 1;
+    result.normal = manifold.normal;
+    result.penetration = manifold.referencePenetration - glm::dot(delta, manifold.normal);
+    result.hit = result.penetration > 0.0f;
+    return true;
+}
+
+void PhysicsSystem::narrowphaseRun(size_t runStart, size_t runEnd) {
+    // Resting contacts reuse their manifold, the rest are culled four at a time with the
+    // batched SAT kernel before the full SAT computes the contact
+    int first = candidatePairs[runStart].first;
+    OBB obbA = bodies.getOBB(first);
+
+    size_t pairIndices[OBB_BATCH_WIDTH];
+    int indices[OBB_BATCH_WIDTH];
+    int count = 0;
+    auto flush = [&]() {
+        OBBBatch batch;
+        gatherOBBBatch(bodies, indices, count, batch);
+        int overlapMask = overlapOBBBatch(obbA, batch);
+
+        for (int lane = 0; lane < count; ++lane) {
+            if (!(overlapMask & (1 << lane))) continue;
+            ContactResult &result = contactResults[pairIndices[lane]];
+            result.tested = 1;
+            result.hit = checkCollisionSAT(obbA, bodies.getOBB(indices[lane]), result.normal, result.penetration);
+        }
+        count = 0;
+        };
+
+    for (size_t i = runStart; i < runEnd; ++i) {
+        if (reuseManifold(i)) continue;
+        pairIndices[count] = i;
+        indices[count] = candidatePairs[i].second;
+        if (++count == OBB_BATCH_WIDTH) flush();
+    }
+    if (count > 0) flush();
+}
 
-            if (!a.rigidBody->isCollisionEnabled || !b.rigidBody->isCollisionEnabled) continue;
-            if (a.rigidBody->isStatic && b.rigidBody->isStatic) continue; // Skip static-static
+void PhysicsSystem::solveContacts() {
+    // Per-contact constants
+    for (ContactManifold *manifold : activeManifolds) {
+        RigidBody *a = physicsObjects[manifold->bodyA].rigidBody;
+        RigidBody *b = physicsObjects[manifold->bodyB].rigidBody;
+        manifold->inverseMassA = a->isStatic ? 0.0f : 1.0f / a->mass;
+        manifold->inverseMassB = b->isStatic ? 0.0f : 1.0f / b->mass;
+
+        // Dynamic pairs bounce like the softer body, contacts with level geometry like the bouncier one
+        bool bothDynamic = !a->isStatic && !b->isStatic;
+        float e = bothDynamic ? std::min(a->restitution, b->restitution) : std::max(a->restitution, b->restitution);
+        float approachSpeed = -glm::dot(a->velocity - b->velocity, manifold->normal);
+        manifold->velocityBias = approachSpeed > RESTITUTION_THRESHOLD ? e * approachSpeed : 0.0f;
+        manifold->friction = std::sqrt(a->friction * b->friction);
+    }
 
-            // Check collision masks
-            if ((a.rigidBody->collisionMask & b.rigidBody->collisionMask) == 0) continue;
+    // Warm start with last step's impulse
+    for (ContactManifold *manifold : activeManifolds) {
+        glm::vec3 impulse = manifold->normal * manifold->normalImpulse + manifold->tangentImpulse;
+        physicsObjects[manifold->bodyA].rigidBody->velocity += impulse * manifold->inverseMassA;
+        physicsObjects[manifold->bodyB].rigidBody->velocity -= impulse * manifold->inverseMassB;
+    }
 
-            glm::vec3 normal;
-            float penetration;
-            if (checkCollisionSAT(a.worldOBB, b.worldOBB, normal, penetration)) {
-                resolveCollision(a, b, normal, penetration);
+    // Sequential impulses. The accumulated normal impulse never pulls, and friction is limited
+    // to the Coulomb cone of the normal impulse.
+    for (int iteration = 0; iteration < solverIterations; ++iteration) {
+        for (ContactManifold *manifold : activeManifolds) {
+            RigidBody *a = physicsObjects[manifold->bodyA].rigidBody;
+            RigidBody *b = physicsObjects[manifold->bodyB].rigidBody;
+            float inverseMassSum = manifold->inverseMassA + manifold->inverseMassB;
+            if (inverseMassSum <= 0.0f) continue;
+
+            float normalSpeed = glm::dot(a->velocity - b->velocity, manifold->normal);
+            float lambda = (manifold->velocityBias - normalSpeed) / inverseMassSum;
+            float previous = manifold->normalImpulse;
+            manifold->normalImpulse = std::max(previous + lambda, 0.0f);
+            lambda = manifold->normalImpulse - previous;
+
+            glm::vec3 impulse = manifold->normal * lambda;
+            a->velocity += impulse * manifold->inverseMassA;
+            b->velocity -= impulse * manifold->inverseMassB;
+
+            // Friction opposes the sliding velocity
+            glm::vec3 relativeVelocity = a->velocity - b->velocity;
+            glm::vec3 slide = relativeVelocity - manifold->normal * glm::dot(relativeVelocity, manifold->normal);
+            glm::vec3 previousTangent = manifold->tangentImpulse;
+            manifold->tangentImpulse -= slide / inverseMassSum;
+            float maxFriction = manifold->friction * manifold->normalImpulse;
+            if (glm::length2(manifold->tangentImpulse) > maxFriction * maxFriction) {
+                manifold->tangentImpulse = glm::normalize(manifold->tangentImpulse) * maxFriction;
             }
+            impulse = manifold->tangentImpulse - previousTangent;
+            a->velocity += impulse * manifold->inverseMassA;
+            b->velocity -= impulse * manifold->inverseMassB;
         }
     }
+
+    // Push overlapping bodies apart, leaving a little penetration so the contact is still there next step.
+    // Corrections of earlier contacts are tracked per body so a stack is straightened out in a few passes.
+    positionShifts.assign(physicsObjects.size(), glm::vec3(0.0f));
+    for (int iteration = 0; iteration < POSITION_ITERATIONS; ++iteration) {
+        for (ContactManifold *manifold : activeManifolds) {
+            float inverseMassSum = manifold->inverseMassA + manifold->inverseMassB;
+            if (inverseMassSum <= 0.0f) continue;
+
+            glm::vec3 &shiftA = positionShifts[manifold->bodyA];
+            glm::vec3 &shiftB = positionShifts[manifold->bodyB];
+            float penetration = manifold->penetration - glm::dot(shiftA - shiftB, manifold->normal);
+            float correction = std::max(penetration - CONTACT_SLOP, 0.0f) * CONTACT_CORRECTION / inverseMassSum;
+            shiftA += manifold->normal * correction * manifold->inverseMassA;
+            shiftB -= manifold->normal * correction * manifold->inverseMassB;
+        }
+    }
+    for (size_t i = 0; i < positionShifts.size(); ++i) {
+        physicsObjects[i].gameObject->position += positionShifts[i];
+    }
 }
 
 // Helper for SAT test on a single axis
@@ -196,220 +773,167 @@ bool PhysicsSystem::checkCollisionSAT(const OBB &a, const OBB &b, glm::vec3 &out
     return true;
 }
 
-void PhysicsSystem::resolveCollision(PhysicsObject &a, PhysicsObject &b, const glm::vec3 &normal, float penetration) {
-    // Helper for velocity reflection
-    auto reflectVelocity = [](RigidBody *rb, float &velocityComponent, float restitution, float sign) {
-        // Only reflect if moving towards the collision
-        if (velocityComponent * sign < 0) {
-            velocityComponent = -velocityComponent * restitution;
+glm::vec3 PhysicsSystem::computeHitNormal(const OBB &obb, const glm::vec3 &point) {
+    glm::vec3 localPoint = point - obb.center;
+    glm::vec3 normal(0.0f);
+    float minDepth = std::numeric_limits<float>::max();
+
+    for (int i = 0; i < 3; ++i) {
+        float dist = glm::dot(localPoint, obb.axes[i]);
+        float depth = obb.halfExtents[i] - std::abs(dist);
+        if (depth < minDepth) {
+            minDepth = depth;
+            normal = obb.axes[i] * (dist > 0 ? 1.0f : -1.0f);
+        }
+    }
+    return normal;
+}
+
+RaycastHit PhysicsSystem::raycast(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance) {
+    prepareRaycastTrees();
+    RaycastHit hit;
+    hit.distance = maxDistance;
 
-            // Stop micro-bouncing (resting contact threshold)
-            if (std::abs(velocityComponent) < 0.5f) {
-                velocityComponent = 0.0f;
+    int hitIndex = -1;
+    auto intersect = [&](const int *indices, int count, float maxDist) {
+        OBBBatch batch;
+        gatherOBBBatch(bodies, indices, count, batch);
+        float t[OBB_BATCH_WIDTH];
+        int hitMask = raycastOBBBatch(origin, direction, maxDist, batch, t);
+
+        float nearest = -1.0f;
+        for (int lane = 0; lane < count; ++lane) {
+            if (!(hitMask & (1 << lane))) continue;
+            int index = indices[lane];
+            // Strictly closer hits only, so ties keep the first body like the linear scan did
+            if (t[lane] < hit.distance || (t[lane] == hit.distance && index < hitIndex)) {
+                hit.distance = t[lane];
+                hitIndex = index;
+                nearest = t[lane];
             }
         }
+        return nearest;
         };
 
-    if (!a.rigidBody->isStatic && !b.rigidBody->isStatic) {
-        // Both dynamic: split penetration
-        a.gameObject->position += normal * penetration * 0.5f;
-        b.gameObject->position -= normal * penetration * 0.5f;
-
-        // Simple velocity reflection along normal
-        glm::vec3 vRel = a.rigidBody->velocity - b.rigidBody->velocity;
-        float vRelNormal = glm::dot(vRel, normal);
-
-        // Do not resolve if velocities are separating
-        if (vRelNormal > 0) return;
-
-        float e = std::min(a.rigidBody->restitution, b.rigidBody->restitution);
-        float j = -(1 + e) * vRelNormal;
-        j /= (1 / a.rigidBody->mass + 1 / b.rigidBody->mass);
-
-        glm::vec3 impulse = j * normal;
-        a.rigidBody->velocity += impulse / a.rigidBody->mass;
-        b.rigidBody->velocity -= impulse / b.rigidBody->mass;
-
-    } else if (!a.rigidBody->isStatic) {
-        // A is dynamic
-        a.gameObject->position += normal * penetration;
-
-        glm::vec3 vRel = a.rigidBody->velocity; // B is static, vB = 0
-        float vRelNormal = glm::dot(vRel, normal);
-
-        if (vRelNormal > 0) return;
+    staticTree.raycast(origin, direction, hit.distance, false, intersect);
+    dynamicTree.raycast(origin, direction, hit.distance, false, intersect);
 
-        float e = std::max(a.rigidBody->restitution, b.rigidBody->restitution);
-
-        // Apply impulse
-        glm::vec3 vn = vRelNormal * normal;
-        glm::vec3 vt = vRel - vn; // Tangential velocity (friction could be applied here)
-
-        // Debug print
-        // std::cout << "Collision! Normal: " << normal.x << ", " << normal.y << ", " << normal.z 
-        //           << " vRelNormal: " << vRelNormal 
-        //           << " e: " << e << std::endl;
+    if (hitIndex >= 0) {
+        const PhysicsObject &obj = physicsObjects[hitIndex];
+        hit.hit = true;
+        hit.point = origin + direction * hit.distance;
+        hit.object = obj.gameObject;
+        hit.normal = computeHitNormal(bodies.getOBB(hitIndex), hit.point);
+    }
 
-        a.rigidBody->velocity = vt - vn * e;
+    return hit;
+}
 
-        // Threshold for resting
-        // if (glm::length(a.rigidBody->velocity) < 0.1f) a.rigidBody->velocity = glm::vec3(0.0f);
-        if (glm::length(a.rigidBody->velocity) < 0.5f) {
-            // Only zero out if normal velocity is small (resting contact)
-            if (std::abs(vRelNormal) < 1.0f) {
-                a.rigidBody->velocity = glm::vec3(0.0f);
-            }
+bool PhysicsSystem::raycastAny(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance) {
+    prepareRaycastTrees();
+    auto intersect = [&](const int *indices, int count, float maxDist) {
+        OBBBatch batch;
+        gatherOBBBatch(bodies, indices, count, batch);
+        float t[OBB_BATCH_WIDTH];
+        int hitMask = raycastOBBBatch(origin, direction, maxDist, batch, t);
+        for (int lane = 0; lane < count; ++lane) {
+            if (hitMask & (1 << lane)) return t[lane];
         }
+        return -1.0f;
+        };
 
-    } else if (!b.rigidBody->isStatic) {
-        // B is dynamic
-        b.gameObject->position -= normal * penetration;
+    return staticTree.raycast(origin, direction, maxDistance, true, intersect) ||
+        dynamicTree.raycast(origin, direction, maxDistance, true, intersect);
+}
 
-        glm::vec3 vRel = -b.rigidBody->velocity; // A is static, vA = 0
-        float vRelNormal = glm::dot(vRel, normal);
+void PhysicsSystem::queryBodies(const AABB &bounds, uint32_t mask, std::vector<int> &out) const {
+    out.clear();
+    auto collect = [&](const DynamicAABBTree &tree, int proxyId) {
+        int index = tree.getUserData(proxyId);
+        if (bodies.masks[index] & mask) out.push_back(index);
+        return true;
+        };
+    staticBroadphase.query(bounds, [&](int proxyId) { return collect(staticBroadphase, proxyId); });
+    dynamicBroadphase.query(bounds, [&](int proxyId) { return collect(dynamicBroadphase, proxyId); });
+    // Same order as a scan over all bodies
+    std::sort(out.begin(), out.end());
+}
 
-        if (vRelNormal > 0) return;
+void PhysicsSystem::pushDynamicBody(int index, const glm::vec3 &normal) {
+    RigidBody *rb = physicsObjects[index].rigidBody;
+    if (rb->isStatic) return;
 
-        float e = std::max(a.rigidBody->restitution, b.rigidBody->restitution);
+    // Apply a small impulse to the object away from the player
+    // Normal points from Obj to Player, so -normal is force direction
+    glm::vec3 pushForce = -normal * 10.0f;
+    pushForce.y = 0.0f; // Keep it horizontal for now to avoid stomping
+    // addForce wakes the body, its island follows on the next step
+    rb->addForce(pushForce);
+}
 
-        glm::vec3 vn = vRelNormal * normal;
-        glm::vec3 vt = vRel - vn;
+CharacterMoveResult PhysicsSystem::moveCharacter(const AABB &box, const glm::vec3 &displacement, uint32_t mask) {
+    CharacterMoveResult result;
+    glm::vec3 start = (box.min + box.max) * 0.5f;
+    glm::vec3 center = start;
+    glm::vec3 extents = (box.max - box.min) * 0.5f;
+    glm::vec3 axes[3] = { glm::vec3(1,0,0), glm::vec3(0,1,0), glm::vec3(0,0,1) };
 
-        // Note: vRel was A-B, so -vB. 
-        // New vB should be reflected.
-        // Let's simplify: just reflect B's velocity along normal
-        glm::vec3 vB = b.rigidBody->velocity;
-        float vBn = glm::dot(vB, normal);
-        glm::vec3 vBnVec = vBn * normal;
-        glm::vec3 vBtVec = vB - vBnVec;
+    // One broadphase query covers the whole move
+    syncBodyMasks();
+    AABB sweptBounds(glm::min(box.min, box.min + displacement) - glm::vec3(CHARACTER_SKIN),
+        glm::max(box.max, box.max + displacement) + glm::vec3(CHARACTER_SKIN));
+    queryBodies(sweptBounds, mask, characterCandidates);
 
-        b.rigidBody->velocity = vBtVec - vBnVec * e;
+    auto classify = [&](const glm::vec3 &normal) {
+        result.collided = true;
+        if (normal.y > GROUND_NORMAL_MIN_Y) result.hitGround = true;
+        if (-normal.y > GROUND_NORMAL_MIN_Y) result.hitCeiling = true;
+        };
 
-        // if (glm::length(b.rigidBody->velocity) < 0.1f) b.rigidBody->velocity = glm::vec3(0.0f);
-        if (glm::length(b.rigidBody->velocity) < 0.5f) {
-            if (std::abs(vRelNormal) < 1.0f) {
-                b.rigidBody->velocity = glm::vec3(0.0f);
-            }
-        }
+    // Start by getting out of anything that moved into the box since the last move
+    glm::vec3 depenetration(0.0f);
+    OBB startBox(center, axes, extents);
+    for (int i : characterCandidates) {
+        SweepResult overlap = sweepOBB(startBox, glm::vec3(0.0f), bodies.getOBB(i));
+        if (!overlap.overlapping) continue;
+        depenetration += overlap.normal * overlap.penetration;
+        classify(overlap.normal);
+        pushDynamicBody(i, overlap.normal);
     }
-}
-
-RaycastHit PhysicsSystem::raycast(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance) {
-    RaycastHit hit;
-    hit.distance = maxDistance;
-
-    glm::vec3 invDir = 1.0f / direction;
-
-    for (auto &obj : physicsObjects) {
-        // Ray vs OBB
-        // Transform ray to OBB local space
-        OBB &obb = obj.worldOBB;
-
-        glm::vec3 p = obb.center - origin;
-
-        glm::vec3 f(
-            glm::dot(obb.axes[0], direction),
-            glm::dot(obb.axes[1], direction),
-            glm::dot(obb.axes[2], direction)
-        );
-
-        glm::vec3 e(
-            glm::dot(obb.axes[0], p),
-            glm::dot(obb.axes[1], p),
-            glm::dot(obb.axes[2], p)
-        );
-
-        float t[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
-        // Test against 3 pairs of planes
-        float tmin = 0.0f;
-        float tmax = maxDistance;
-
-        for (int i = 0; i < 3; i++) {
-            float r = obb.halfExtents[i];
-            if (std::abs(f[i]) > 1e-6f) {
-                float t1 = (e[i] + r) / f[i];
-                float t2 = (e[i] - r) / f[i];
-                if (t1 > t2) std::swap(t1, t2);
-                if (t1 > tmin) tmin = t1;
-                if (t2 < tmax) tmax = t2;
-                if (tmin > tmax) goto next_obj;
-                if (tmax < 0) goto next_obj;
-            } else if (-e[i] - r > 0 || -e[i] + r < 0) {
-                goto next_obj;
+    center += depenetration;
+
+    // Move and slide: advance to the first contact, drop the blocked part of the move, repeat
+    glm::vec3 remaining = displacement;
+    for (int iteration = 0; iteration < CHARACTER_SLIDE_ITERATIONS; ++iteration) {
+        float length = glm::length(remaining);
+        if (length < CHARACTER_MIN_MOVE) break;
+
+        OBB moving(center, axes, extents);
+        SweepResult first;
+        int firstIndex = -1;
+        for (int i : characterCandidates) {
+            SweepResult sweep = sweepOBB(moving, remaining, bodies.getOBB(i));
+            if (sweep.hit && sweep.time < first.time) {
+                first = sweep;
+                firstIndex = i;
             }
         }
-
-        if (tmin > 0 && tmin < hit.distance) {
-            hit.hit = true;
-            hit.distance = tmin;
-            hit.point = origin + direction * tmin;
-            hit.object = obj.gameObject;
-
-            // Calculate normal
-            glm::vec3 localPoint = hit.point - obb.center;
-            glm::vec3 normal(0.0f);
-            float minDepth = std::numeric_limits<float>::max();
-
-            for (int i = 0; i < 3; ++i) {
-                float dist = glm::dot(localPoint, obb.axes[i]);
-                float depth = obb.halfExtents[i] - std::abs(dist);
-                if (depth < minDepth) {
-                    minDepth = depth;
-                    normal = obb.axes[i] * (dist > 0 ? 1.0f : -1.0f);
-                }
-            }
-            hit.normal = normal;
+        if (firstIndex < 0) {
+            center += remaining;
+            break;
         }
 
-    next_obj:;
-    }
-
-    return hit;
-}
-
-bool PhysicsSystem::checkPlayerCollision(const AABB &playerAABB, glm::vec3 &outCorrection, uint32_t playerMask) {
-    outCorrection = glm::vec3(0.0f);
-    bool collided = false;
+        // Stop just short of the contact so the next sweep does not start inside it
+        float travel = std::max(first.time - CHARACTER_SKIN / length, 0.0f);
+        center += remaining * travel;
+        classify(first.normal);
+        pushDynamicBody(firstIndex, first.normal);
 
-    // Convert Player AABB to OBB for SAT check
-    glm::vec3 center = (playerAABB.min + playerAABB.max) * 0.5f;
-    glm::vec3 extents = (playerAABB.max - playerAABB.min) * 0.5f;
-    glm::vec3 axes[3] = { glm::vec3(1,0,0), glm::vec3(0,1,0), glm::vec3(0,0,1) };
-    OBB playerOBB(center, axes, extents);
-
-    for (auto &obj : physicsObjects) {
-        // Check collision mask
-        if ((obj.rigidBody->collisionMask & playerMask) == 0) continue;
-
-        // if (!obj.rigidBody->isStatic) continue; // Allow collision with dynamic objects
-
-        glm::vec3 normal;
-        float penetration;
-        if (checkCollisionSAT(playerOBB, obj.worldOBB, normal, penetration)) {
-            // Accumulate correction? Or just take the largest?
-            // For simple character controller, resolving one by one is okay-ish, 
-            // but taking the max penetration is safer to avoid jitter.
-            // Here we just apply the first one found (simple) or sum them (can be unstable).
-            // Let's try resolving immediately.
-
-            // Important: SAT normal points from B to A. 
-            // Here A is player, B is obj. So normal points towards player.
-            // We want to push player OUT of obj.
-
-            outCorrection += normal * penetration;
-            collided = true;
-
-            // Simple interaction: Push dynamic objects
-            if (!obj.rigidBody->isStatic) {
-                // Apply a small impulse to the object away from the player
-                // Normal points from Obj to Player, so -normal is force direction
-                glm::vec3 pushForce = -normal * 10.0f;
-                pushForce.y = 0.0f; // Keep it horizontal for now to avoid stomping
-                obj.rigidBody->addForce(pushForce);
-
-                // Also wake it up if sleeping (not implemented yet, but good practice)
-            }
-        }
+        remaining *= 1.0f - travel;
+        float into = glm::dot(remaining, first.normal);
+        if (into < 0.0f) remaining -= first.normal * into;
     }
-    return collided;
+
+    result.movement = center - start;
+    return result;
 }
\ No newline at end of file
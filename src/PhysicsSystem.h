@@ -1,7 +1,15 @@
 #pragma once
 
+#include "Collider.h"
+#include "DynamicAABBTree.h"
+#include "BVH.h"
+#include "PhysicsBodyStore.h"
+#include "JobSystem.h"
+
 #include <vector>
 #include <memory>
+#include <algorithm>
+#include <unordered_map>
 
 #include <glm/glm.hpp>
 
@@ -13,31 +21,6 @@ constexpr uint32_t COLLISION_MASK_NEARPORTAL = 0xF2;
 // Forward declaration
 class GameObject;
 
-// Basic AABB Collider
-struct AABB {
-    glm::vec3 min;
-    glm::vec3 max;
-
-    AABB(const glm::vec3 &min = glm::vec3(0.0f), const glm::vec3 &max = glm::vec3(0.0f))
-        : min(min), max(max) {
-    }
-};
-
-// Oriented Bounding Box
-struct OBB {
-    glm::vec3 center;
-    glm::vec3 axes[3]; // Local x, y, z axes in world space (normalized)
-    glm::vec3 halfExtents;
-
-    OBB() {}
-    OBB(const glm::vec3 &center, const glm::vec3 axes[3], const glm::vec3 &halfExtents)
-        : center(center), halfExtents(halfExtents) {
-        this->axes[0] = axes[0];
-        this->axes[1] = axes[1];
-        this->axes[2] = axes[2];
-    }
-};
-
 // RigidBody Component
 struct RigidBody {
     glm::vec3 velocity = glm::vec3(0.0f);
@@ -47,13 +30,24 @@ struct RigidBody {
     bool useGravity = true;
     bool isStatic = false;
     bool isCollisionEnabled = true; // Enable/Disable collision response
-    float friction = 0.5f;
+    float friction = 0.5f; // Coulomb coefficient, combined per contact as sqrt(a * b)
     float restitution = 0.2f; // Bounciness
     uint32_t collisionMask = 0xFFFFFFFF; // Bitmask for collision filtering
     bool isOnGround = false;
 
+    // Sleeping bodies are skipped by integration and narrowphase until something wakes them
+    bool isSleeping = false;
+    float sleepTimer = 0.0f; // Time spent below the sleep velocity threshold
+    int islandId = -1; // Island the body fell asleep in
+
     void addForce(const glm::vec3 &f) {
         force += f;
+        if (isSleeping) wake();
+    }
+
+    void wake() {
+        isSleeping = false;
+        sleepTimer = 0.0f;
     }
 
     void clearForces() {
@@ -70,9 +64,18 @@ struct RaycastHit {
     GameObject *object = nullptr;
 };
 
+// Outcome of PhysicsSystem::moveCharacter
+struct CharacterMoveResult {
+    glm::vec3 movement = glm::vec3(0.0f); // How far the box actually moved
+    bool collided = false;
+    bool hitGround = false; // Touched a surface facing up
+    bool hitCeiling = false; // Touched a surface facing down
+};
+
 class PhysicsSystem {
 public:
-    PhysicsSystem();
+    // Integration and the narrowphase are spread over workerThreads extra threads (0 runs them inline)
+    explicit PhysicsSystem(unsigned workerThreads = JobSystem::defaultWorkerCount());
     ~PhysicsSystem();
 
     void setGravity(const glm::vec3 &g);
@@ -82,31 +85,185 @@ public:
         RigidBody *rigidBody;
         AABB *collider; // Local space AABB
 
-        // World space OBB cache
-        OBB worldOBB;
+        // Stable id, unlike the index it survives removals; keys the contact manifolds
+        uint32_t bodyId = 0;
+
+        // Transform version the world OBB was built from
+        uint32_t transformVersion = 0;
+
+        // Broadphase proxy (leaf in the dynamic AABB tree)
+        int proxyId = DynamicAABBTree::NullNode;
+
+        // Sleep state seen at the end of the last step, used to notice external wake-ups
+        bool wasSleeping = false;
+    };
+
+    // Per-step counters, useful for profiling the collision pipeline
+    struct Stats {
+        size_t bodyCount = 0;
+        size_t candidatePairs = 0; // Pairs whose fat AABBs overlap in the broadphase
+        size_t narrowphaseTests = 0; // Pairs that reached checkCollisionSAT
+        size_t contacts = 0;
+        size_t reusedContacts = 0; // Resting contacts taken from their manifold without SAT
+        size_t sleepingBodies = 0;
     };
 
     void addObject(GameObject *obj, RigidBody *rb, AABB *col);
     void removeObject(GameObject *obj);
 
+    size_t getBodyCount() const { return physicsObjects.size(); }
+    // Makes room for bodyCount bodies in total, in the body arrays, the dynamic broadphase and
+    // the per-body step scratch, so adding bodies up to that count does not regrow them
+    void reserve(size_t bodyCount);
+
     // Character Controller Helper
-    // Checks if the given AABB overlaps with any static physics object.
-    // Returns true if collision found, and sets correction vector to resolve it.
-    bool checkPlayerCollision(const AABB &playerAABB, glm::vec3 &outCorrection, uint32_t playerMask = COLLISION_MASK_DEFAULT);
+    // Sweeps the box along displacement and slides along whatever it hits, pushing dynamic bodies.
+    // Overlaps present at the start are resolved first. Replaces separate overlap passes per axis.
+    CharacterMoveResult moveCharacter(const AABB &box, const glm::vec3 &displacement, uint32_t mask = COLLISION_MASK_DEFAULT);
 
     void update(float dt);
 
+    // Forgets the cached contacts (warm starting, resting pairs), e.g. after bodies were put
+    // back to a saved state. The next step rebuilds them with a full narrowphase.
+    void resetContacts();
+
+    const Stats &getStats() const { return stats; }
+
+    // The worker pool, shared with other per-step systems such as trigger evaluation
+    JobSystem &getJobSystem() { return jobs; }
+
+    // Velocity iterations of the contact solver; more iterations let taller stacks settle
+    void setSolverIterations(int iterations) { solverIterations = std::max(iterations, 1); }
+    int getSolverIterations() const { return solverIterations; }
+
     // Raycasting
+    // Closest hit along the ray. Static and dynamic bodies are searched through separate BVHs.
     RaycastHit raycast(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance);
+    // Occlusion-style query: returns as soon as any body is hit within maxDistance
+    bool raycastAny(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance);
 
 private:
     glm::vec3 gravity;
     std::vector<PhysicsObject> physicsObjects;
+    PhysicsBodyStore bodies; // Collision data of physicsObjects[i], including its world OBB
+
+    // Broadphase: static and dynamic bodies live in separate trees so large level geometry
+    // does not bloat the nodes that dynamic bodies are sorted into
+    DynamicAABBTree staticBroadphase;
+    DynamicAABBTree dynamicBroadphase;
+    std::vector<std::pair<int, int>> candidatePairs;
+    Stats stats;
+
+    // Parallel stages
+    JobSystem jobs;
+    enum BodyMoveState : uint8_t {
+        BodyUnchanged,
+        BodyIntegrated,
+        BodyStaticMoved
+    };
+    std::vector<uint8_t> bodyMoved; // Per body, written by the integration jobs
+    std::vector<uint8_t> keptBodies; // removeObject scratch, kept so despawning does not allocate
+    struct ContactResult {
+        glm::vec3 normal = glm::vec3(0.0f);
+        float penetration = 0.0f;
+        uint8_t tested = 0; // Passed the batched cull and reached checkCollisionSAT
+        uint8_t reused = 0; // Taken from a resting manifold instead
+        uint8_t hit = 0;
+    };
+    std::vector<ContactResult> contactResults; // Parallel to candidatePairs
+    std::vector<size_t> pairRuns; // Start of each run of pairs sharing a first body, plus the end
+
+    // Contact manifolds persist while a pair keeps touching, carrying the solver impulse
+    // into the next step (warm starting)
+    struct ContactManifold {
+        int bodyA = 0; // Body indices for the current step
+        int bodyB = 0;
+        glm::vec3 normal = glm::vec3(0.0f); // From B to A
+        float penetration = 0.0f;
+        float normalImpulse = 0.0f; // Accumulated over iterations and steps
+        glm::vec3 tangentImpulse = glm::vec3(0.0f); // Friction, perpendicular to the normal
+        uint32_t lastStep = 0;
+
+        // Relative pose when SAT last ran, lets resting contacts skip the narrowphase
+        bool hasReference = false;
+        glm::vec3 referenceOffset = glm::vec3(0.0f);
+        glm::vec3 referenceAxes[4];
+        float referencePenetration = 0.0f;
+
+        // Solver scratch
+        float inverseMassA = 0.0f;
+        float inverseMassB = 0.0f;
+        float velocityBias = 0.0f;
+        float friction = 0.0f;
+    };
+    std::unordered_map<uint64_t, ContactManifold> manifolds;
+    std::vector<ContactManifold *> activeManifolds; // Touching this step, in pair order
+    std::vector<glm::vec3> positionShifts; // Per body position correction of this step
+    uint32_t manifoldStep = 0;
+    uint32_t nextBodyId = 0;
+    int solverIterations = 8;
+
+    static uint64_t manifoldKey(const PhysicsObject &a, const PhysicsObject &b) {
+        return (static_cast<uint64_t>(a.bodyId) << 32) | b.bodyId;
+    }
+
+    // Ray query acceleration: static level geometry is built once and only refit when a
+    // static body is moved (portal frames, flip walls); dynamic bodies are refit every step.
+    BVH staticTree;
+    BVH dynamicTree;
+    bool raycastTreesDirty = true;
+    bool staticTreeMoved = false;
+    bool dynamicTreeMoved = false;
+
+    // Ground detection
+    struct GroundProbe {
+        int bodyIndex;
+        glm::vec3 origin;
+        float length;
+    };
+    std::vector<uint8_t> groundContacts; // Per body: supported by a contact this step
+    std::vector<GroundProbe> groundProbes;
+
+    // Sleeping and islands
+    std::vector<std::pair<int, int>> islandContacts; // Dynamic-dynamic contacts of this step
+    std::vector<int> islandParents; // Union-find forest over body indices
+    std::vector<uint8_t> islandCanSleep;
+    std::vector<int> islandIds;
+    std::unordered_map<int, std::vector<int>> islandMembers; // Body indices of each sleeping island
+    std::vector<int> islandRemap; // Old to new body index during removeObject, -1 for removed
+    std::vector<int> movedStaticBodies;
+    int nextIslandId = 0;
 
+    void syncBodyState();
+    void syncBodyMasks();
     void integrate(PhysicsObject &obj, float dt);
+    void integrateBody(size_t index, float dt);
+    void updateBodyOBB(size_t index);
+    DynamicAABBTree &broadphaseFor(const PhysicsObject &obj) { return obj.rigidBody->isStatic ? staticBroadphase : dynamicBroadphase; }
+    void updateBroadphase(float dt);
+    void prepareRaycastTrees(); // Rebuilds the trees between steps when bodies changed
+    void updateRaycastTrees();
+    void findCandidatePairs();
     void checkCollisions();
-    void resolveCollision(PhysicsObject &a, PhysicsObject &b, const glm::vec3 &normal, float penetration);
+    void narrowphaseRun(size_t runStart, size_t runEnd);
+    bool reuseManifold(size_t pairIndex);
+    void solveContacts();
+
+    // Character queries
+    std::vector<int> characterCandidates;
+    void queryBodies(const AABB &bounds, uint32_t mask, std::vector<int> &out) const;
+    void pushDynamicBody(int index, const glm::vec3 &normal);
+    void updateGroundState();
+
+    void updateSleeping(float dt);
+    int findIslandRoot(int index);
+    void wakeIsland(int islandId);
+    void remapIslandMembers();
+    void wakeTouchedIslands();
+    void wakeBodiesNearMovedStatics();
 
     // SAT Helper
     bool checkCollisionSAT(const OBB &a, const OBB &b, glm::vec3 &outNormal, float &outPenetration);
+
+    static glm::vec3 computeHitNormal(const OBB &obb, const glm::vec3 &point);
 };
@@ -115,43 +115,30 @@ void Player::update(float dt, PhysicsSystem *physicsSystem) {
     // Proposed movement
     glm::vec3 displacement = rigidBody->velocity * dt;
 
-    position.y += displacement.y;
-    // Update collider (centered on position)
+    // Collider at the start of the move (teleports and respawns move the player directly)
     collider->min = position + glm::vec3(-radius, -height * 0.5f, -radius);
     collider->max = position + glm::vec3(radius, height * 0.5f, radius);
 
     if (!rigidBody->isCollisionEnabled) {
         // Skip collision check
+        position += displacement;
     } else {
-        glm::vec3 correction;
-        if (physicsSystem->checkPlayerCollision(*collider, correction, rigidBody->collisionMask)) {
-            position += correction;
-            if (rigidBody->velocity.y < 0 && correction.y > 0) {
-                isGrounded = true;
-                rigidBody->velocity.y = 0;
-            } else if (rigidBody->velocity.y > 0 && correction.y < 0) {
-                rigidBody->velocity.y = 0;
-            }
-        } else {
-            isGrounded = false;
+        // One swept query moves the player and slides along walls and floors
+        CharacterMoveResult move = physicsSystem->moveCharacter(*collider, displacement, rigidBody->collisionMask);
+        position += move.movement;
+
+        isGrounded = move.hitGround;
+        if (move.hitGround && rigidBody->velocity.y < 0) {
+            rigidBody->velocity.y = 0;
+        } else if (move.hitCeiling && rigidBody->velocity.y > 0) {
+            rigidBody->velocity.y = 0;
         }
     }
 
-
-    // Move X/Z
-    glm::vec3 horizontalDisp = glm::vec3(displacement.x, 0.0f, displacement.z);
-    position += horizontalDisp;
-
+    // Update collider (centered on position)
     collider->min = position + glm::vec3(-radius, -height * 0.5f, -radius);
     collider->max = position + glm::vec3(radius, height * 0.5f, radius);
 
-    if (rigidBody->isCollisionEnabled) {
-        glm::vec3 correction;
-        if (physicsSystem->checkPlayerCollision(*collider, correction, rigidBody->collisionMask)) {
-            position += correction;
-        }
-    }
-
     if (isGrabbing && grabbedObject) {
         glm::vec3 targetPos = position + camera.Front * 2.0f + glm::vec3(0.0f, height * 0.5f, 0.0f);
         if (glm::length(targetPos - grabbedObject->position) > 3.0f) {
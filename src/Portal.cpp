@@ -4,6 +4,10 @@
 
 Portal::Portal(int width, int height, glm::vec3 pos, glm::vec3 rot, glm::vec3 scale)
     : GameObject(nullptr, pos, rot, scale), linkedPortal(nullptr) {
+    // Portal angles are applied yaw first (Ry * Rx * Rz) so the normal follows yaw/pitch
+    setEulerAngles(rot, EulerOrder::YXZ);
+    previousOrientation = orientation;
+
     frameBuffer[0] = std::make_unique<FrameBuffer>(width, height);
     frameBuffer[1] = std::make_unique<FrameBuffer>(width, height);
 
@@ -49,73 +53,61 @@ Portal::~Portal() {
 }
 
 void Portal::init(Scene *scene) {
-    createFrames(scene->modelResources["cube"].get(), 0.15f, 0.2f);
+    createFrames(scene->getModel("cube"), 0.15f, 0.2f);
     registerFramesPhysics(scene, COLLISION_MASK_PORTALFRAME);
-    nearTrigger = new Trigger(glm::vec3(100.0f), glm::vec3(101.0f));
-    nearTrigger->onEnter = [](GameObject *obj) {
-        obj->setCollisionMask(COLLISION_MASK_NEARPORTAL);
+    PoolPtr<Trigger> near = scene->triggerPool.create(glm::vec3(100.0f), glm::vec3(101.0f));
+    nearTrigger = near.get();
+    // Mask writes go through the event queue so the per-step onInside requests collapse into one write
+    nearTrigger->onEnter = [scene](GameObject *obj) {
+        scene->triggerEvents.setCollisionMask(obj, COLLISION_MASK_NEARPORTAL);
         };
-    nearTrigger->onInside = [](GameObject *obj) {
-        obj->setCollisionMask(COLLISION_MASK_NEARPORTAL);
+    nearTrigger->onInside = [scene](GameObject *obj) {
+        scene->triggerEvents.setCollisionMask(obj, COLLISION_MASK_NEARPORTAL);
         };
-    nearTrigger->onExit = [](GameObject *obj) {
-        obj->setCollisionMask(COLLISION_MASK_DEFAULT);
+    nearTrigger->onExit = [scene](GameObject *obj) {
+        scene->triggerEvents.setCollisionMask(obj, COLLISION_MASK_DEFAULT);
         };
     nearTrigger->isActive = false;
-    scene->addTrigger(name + "NearTrigger", std::unique_ptr<Trigger>(nearTrigger));
-    teleportTrigger = new Trigger(glm::vec3(100.0f), glm::vec3(101.0f));
+    scene->addTrigger(name + "NearTrigger", std::move(near));
+    PoolPtr<Trigger> teleport = scene->triggerPool.create(glm::vec3(100.0f), glm::vec3(101.0f));
+    teleportTrigger = teleport.get();
     teleportTrigger->onEnter = [this](GameObject *obj) {
         if (!linkedPortal || !obj || !obj->isTeleportable) return;
 
-        // Build rotation matrices for source (this) and destination (linkedPortal)
-        // Use Ry * Rx * Rz order to match checkRaycast logic and avoid gimbal lock
-        glm::mat4 srcRot = glm::mat4(1.0f);
-        srcRot = glm::rotate(srcRot, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-        srcRot = glm::rotate(srcRot, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-        srcRot = glm::rotate(srcRot, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
-
-        glm::mat4 dstRot = glm::mat4(1.0f);
-        dstRot = glm::rotate(dstRot, glm::radians(linkedPortal->rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-        dstRot = glm::rotate(dstRot, glm::radians(linkedPortal->rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-        dstRot = glm::rotate(dstRot, glm::radians(linkedPortal->rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
-
         // Add a 180 degree rotation around the portal's local Y to map facing correctly.
-        glm::mat4 rot180 = glm::rotate(glm::mat4(1.0f), glm::radians(180.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        const glm::quat rot180(0.0f, 0.0f, 1.0f, 0.0f); // (w, x, y, z)
+
+        // Source local space -> 180deg -> destination world
+        glm::quat portalRot = linkedPortal->orientation * rot180 * glm::conjugate(orientation);
 
         // Transform position: compute local position in source's local axes, apply 180deg, then transform to dest world
-        glm::vec4 relPos = glm::inverse(srcRot) * glm::vec4(obj->position - this->position, 1.0f);
-        glm::vec4 newWorldPos4 = glm::vec4(linkedPortal->position, 1.0f) + dstRot * (rot180 * relPos);
+        glm::vec3 newWorldPos = linkedPortal->position + portalRot * (obj->position - this->position);
         // push slightly forward along the destination portal normal to avoid immediate re-trigger
-        glm::vec3 dstForward = glm::normalize(glm::vec3(dstRot * glm::vec4(0.0f, 0.0f, 1.0f, 0.0f)));
+        glm::vec3 dstForward = linkedPortal->getTransform().getForward();
         const float teleportForwardPush = 0.15f;
-        obj->position = glm::vec3(newWorldPos4) + dstForward * teleportForwardPush;
+        obj->position = newWorldPos + dstForward * teleportForwardPush;
+        // Teleports are discontinuous, do not interpolate across them
+        obj->storePreviousTransform();
 
-        // Transform velocity if present (treat as direction vector, w=0) with 180deg flip
+        // Transform velocity if present (a direction vector) with 180deg flip
         if (obj->rigidBody) {
-            glm::vec4 relVel = glm::inverse(srcRot) * glm::vec4(obj->rigidBody->velocity, 0.0f);
-            glm::vec4 newVel4 = dstRot * (rot180 * relVel);
-            obj->rigidBody->velocity = glm::vec3(newVel4);
+            obj->rigidBody->wake();
+            obj->rigidBody->velocity = portalRot * obj->rigidBody->velocity;
         }
 
         // If this is the Player, also rotate the camera's orientation (Front/Yaw/Pitch)
         Player *player = dynamic_cast<Player *>(obj);
         if (player) {
             // Transform camera Front vector through src->rot180->dst
-            glm::vec4 relFront = glm::inverse(srcRot) * glm::vec4(player->camera.Front, 0.0f);
-            glm::vec4 newFront4 = dstRot * (rot180 * relFront);
-            glm::vec3 newFront = glm::normalize(glm::vec3(newFront4));
+            glm::vec3 newFront = glm::normalize(portalRot * player->camera.Front);
             player->camera.Front = newFront;
 
             // Transform Up vector
-            glm::vec4 relUp = glm::inverse(srcRot) * glm::vec4(player->camera.Up, 0.0f);
-            glm::vec4 newUp4 = dstRot * (rot180 * relUp);
-            glm::vec3 newUp = glm::normalize(glm::vec3(newUp4));
+            glm::vec3 newUp = glm::normalize(portalRot * player->camera.Up);
             player->camera.Up = newUp;
 
             // Transform Right vector
-            glm::vec4 relRight = glm::inverse(srcRot) * glm::vec4(player->camera.Right, 0.0f);
-            glm::vec4 newRight4 = dstRot * (rot180 * relRight);
-            glm::vec3 newRight = glm::normalize(glm::vec3(newRight4));
+            glm::vec3 newRight = glm::normalize(portalRot * player->camera.Right);
             player->camera.Right = newRight;
 
             // Recompute yaw/pitch from new front vector
@@ -142,12 +134,14 @@ void Portal::init(Scene *scene) {
         }
         };
     teleportTrigger->isActive = false;
-    scene->addTrigger(name + "TeleportTrigger", std::unique_ptr<Trigger>(teleportTrigger));
+    scene->addTrigger(name + "TeleportTrigger", std::move(teleport));
 }
 
 void Portal::createFrames(Model *cubeModel, float thickness, float depth) {
     for (int i = 0; i < 4; ++i) {
         frames[i] = std::make_unique<GameObject>(cubeModel);
+        // Frames are not scene objects, so they hold their own reference on the model
+        cubeModel->retain();
     }
     // Apply initial transform
     updateFramesTransform();
@@ -168,16 +162,12 @@ void Portal::registerFramesPhysics(Scene *scene, uint32_t collisionMask) {
 }
 
 void Portal::updateFramesTransform() {
-    // Compute axes from portal rotation (Ry * Rx * Rz)
-    glm::mat4 rotationMat = glm::mat4(1.0f);
-    rotationMat = glm::rotate(rotationMat, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-    rotationMat = glm::rotate(rotationMat, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-    rotationMat = glm::rotate(rotationMat, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
-
+    // Axes from the cached portal orientation
+    const glm::mat3 &basis = getTransform().getBasis();
     glm::vec3 axes[3];
-    axes[0] = glm::vec3(rotationMat[0]); // right
-    axes[1] = glm::vec3(rotationMat[1]); // up
-    axes[2] = glm::vec3(rotationMat[2]); // forward
+    axes[0] = basis[0]; // right
+    axes[1] = basis[1]; // up
+    axes[2] = basis[2]; // forward
 
     float halfW = scale.x;
     float halfH = scale.y;
@@ -187,22 +177,22 @@ void Portal::updateFramesTransform() {
 
     // Top
     if (frames[0]) {
-        frames[0]->rotation = rotation;
+        frames[0]->orientation = orientation;
         frames[0]->position = position + axes[1] * (halfH + 0.18f - thickness * 0.5f) - axes[2] * (depth * 2.0f - 0.05f);
     }
     // Bottom
     if (frames[1]) {
-        frames[1]->rotation = rotation;
+        frames[1]->orientation = orientation;
         frames[1]->position = position + axes[1] * (-halfH - 0.18f + thickness * 0.5f) - axes[2] * (depth * 2.0f - 0.05f);
     }
     // Left
     if (frames[2]) {
-        frames[2]->rotation = rotation;
+        frames[2]->orientation = orientation;
         frames[2]->position = position + axes[0] * (-halfW - 0.18f + thickness * 0.5f) - axes[2] * (depth * 2.0f - 0.05f);
     }
     // Right
     if (frames[3]) {
-        frames[3]->rotation = rotation;
+        frames[3]->orientation = orientation;
         frames[3]->position = position + axes[0] * (halfW + 0.18f - thickness * 0.5f) - axes[2] * (depth * 2.0f - 0.05f);
     }
 }
@@ -218,34 +208,21 @@ void Portal::checkRaycast(RaycastHit result, glm::vec3 playerRight) {
         result.object->setCollisionMask(COLLISION_MASK_PORTALON);
         onObject = result.object;
 
-        //set position and rotation
+        //set position and orientation
         position = result.point + result.normal * 0.05f;
-        float pitch = -glm::degrees(std::asin(glm::clamp(result.normal.y, -1.0f, 1.0f)));
-        float yaw = 0.0f;
-        if (glm::abs(result.normal.x) > 1e-5 || glm::abs(result.normal.z) > 1e-5) {
-            yaw = glm::degrees(std::atan2(result.normal.x, result.normal.z));
-        }
-        auto portalUp = glm::cross(playerRight, result.normal);
-        float roll = 0.0f;
-        if (abs(portalUp.y) <= 1e-5) {//only roll when on floor/ceil
-            if (result.normal.y > 0) {
-                roll = glm::degrees(std::atan2(portalUp.x, portalUp.z));
-            } else { //ceil
-                roll = -glm::degrees(std::atan2(portalUp.x, portalUp.z));
-            }
-        }
-        rotation = glm::vec3(pitch, yaw, roll);
+        // The portal faces along the normal. On walls its top points up; on floors and ceilings
+        // it points where the player is looking.
+        glm::vec3 forward = result.normal;
+        glm::vec3 worldUp(0.0f, 1.0f, 0.0f);
+        glm::vec3 up = std::abs(forward.y) > 0.999f ? glm::cross(worldUp, playerRight) : worldUp;
+        up = glm::normalize(up - forward * glm::dot(up, forward));
+        glm::vec3 axes[3];
+        axes[0] = glm::cross(up, forward); // right
+        axes[1] = up;
+        axes[2] = forward; // portal normal
+        orientation = glm::quat_cast(glm::mat3(axes[0], axes[1], axes[2]));
 
         // move trigger
-        glm::mat4 rotationMat = glm::mat4(1.0f);
-        rotationMat = glm::rotate(rotationMat, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-        rotationMat = glm::rotate(rotationMat, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-        rotationMat = glm::rotate(rotationMat, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
-
-        glm::vec3 axes[3];
-        axes[0] = glm::vec3(rotationMat[0]); // right
-        axes[1] = glm::vec3(rotationMat[1]); // up
-        axes[2] = glm::vec3(rotationMat[2]); // forward (portal normal)
 
         // Portal width/height from portal->scale (assume x=width, y=height)
         float halfWidth = scale.x;
@@ -279,27 +256,16 @@ void Portal::endRender(int scrWidth, int scrHeight) {
 glm::mat4 Portal::getTransformedView(glm::mat4 view) {
     if (!linkedPortal) return view;
 
-    glm::mat4 myModel = glm::mat4(1.0f);
-    myModel = glm::translate(myModel, position);
-    myModel = glm::rotate(myModel, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-    myModel = glm::rotate(myModel, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-    myModel = glm::rotate(myModel, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
-
-    glm::mat4 otherModel = glm::mat4(1.0f);
-    otherModel = glm::translate(otherModel, linkedPortal->position);
-    otherModel = glm::rotate(otherModel, glm::radians(linkedPortal->rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-    otherModel = glm::rotate(otherModel, glm::radians(linkedPortal->rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-    otherModel = glm::rotate(otherModel, glm::radians(linkedPortal->rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+    // Unscaled portal matrices, the inverse comes from the cache instead of a general 4x4 inverse
+    const glm::mat4 &myModelInverse = getTransform().getInverseRigidMatrix();
+    const glm::mat4 &otherModel = linkedPortal->getTransform().getRigidMatrix();
 
     // Calculate Relative Transform (Camera -> Me)
     glm::mat4 camTransform = glm::inverse(view);
 
-    // Transform Camera to My Local Space
-    glm::mat4 camInLocal = glm::inverse(myModel) * camTransform;
-
     // Rotate 180 degrees around Y (to face out)
     glm::mat4 rotation180 = glm::rotate(glm::mat4(1.0f), glm::radians(180.0f), glm::vec3(0.0f, 1.0f, 0.0f));
-    glm::mat4 destView = otherModel * rotation180 * glm::inverse(myModel) * camTransform;
+    glm::mat4 destView = otherModel * rotation180 * myModelInverse * camTransform;
 
     return glm::inverse(destView);
 }
@@ -307,14 +273,7 @@ glm::mat4 Portal::getTransformedView(glm::mat4 view) {
 glm::vec4 Portal::getPlaneEquation() {
     if (!linkedPortal) return glm::vec4(0.0f);
 
-    glm::mat4 modelMatrix = glm::mat4(1.0f);
-    modelMatrix = glm::translate(modelMatrix, linkedPortal->position);
-    modelMatrix = glm::rotate(modelMatrix, glm::radians(linkedPortal->rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-    modelMatrix = glm::rotate(modelMatrix, glm::radians(linkedPortal->rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-    modelMatrix = glm::rotate(modelMatrix, glm::radians(linkedPortal->rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
-
-    glm::vec3 normal = glm::vec3(modelMatrix * glm::vec4(0.0f, 0.0f, 1.0f, 0.0f));
-    normal = glm::normalize(normal);
+    glm::vec3 normal = glm::normalize(linkedPortal->getTransform().getForward());
 
     // Plane equation: Ax + By + Cz + D = 0
     // D = -dot(N, P)
@@ -349,18 +308,12 @@ void Portal::DrawFrame(Shader &shader) {
         shader.setFloat("material.shininess", 32.0f);
 
         // Calculate frame position: slightly forward along normal to avoid z-fighting
-        glm::mat4 rotationMat = glm::mat4(1.0f);
-        rotationMat = glm::rotate(rotationMat, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-        rotationMat = glm::rotate(rotationMat, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-        rotationMat = glm::rotate(rotationMat, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
-        glm::vec3 normal = glm::normalize(glm::vec3(rotationMat * glm::vec4(0.0f, 0.0f, 1.0f, 0.0f)));
+        const Transform &portalTransform = getTransform();
+        glm::vec3 normal = glm::normalize(portalTransform.getForward());
         glm::vec3 framePos = position + normal * 0.01f;
 
-        glm::mat4 frameModel = glm::mat4(1.0f);
-        frameModel = glm::translate(frameModel, framePos);
-        frameModel = glm::rotate(frameModel, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-        frameModel = glm::rotate(frameModel, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-        frameModel = glm::rotate(frameModel, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+        glm::mat4 frameModel = portalTransform.getRigidMatrix();
+        frameModel[3] = glm::vec4(framePos, 1.0f);
         frameModel = glm::scale(frameModel, scale + glm::vec3(0.2f));
         shader.setMat4("model", frameModel);
 
@@ -379,15 +332,7 @@ void Portal::drawBuffer(int bufferIndex, Shader &portalShader) {
     portalShader.use();
     portalShader.setInt("reflectionTexture", 10);
 
-    // Calculate model matrix
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, position);
-    model = glm::rotate(model, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-    model = glm::rotate(model, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-    model = glm::rotate(model, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
-    model = glm::scale(model, scale);
-
-    portalShader.setMat4("model", model);
+    portalShader.setMat4("model", getTransform().getMatrix());
 
     glBindVertexArray(contentVAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
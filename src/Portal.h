@@ -31,7 +31,7 @@ public:
     void setTeleportTrigger(Trigger *trigger) { teleportTrigger = trigger; }
     Trigger *getTeleportTrigger() { return teleportTrigger; }
 
-    GameObject *getOnObject() { return onObject; }
+    GameObject *getOnObject() const { return onObject; }
     void setOnObject(GameObject *obj) { onObject = obj; }
 
 
@@ -58,7 +58,7 @@ public:
     void createFrames(Model *cubeModel, float thickness = 0.05f, float depth = 0.1f);
     void registerFramesPhysics(struct Scene *scene, uint32_t collisionMask = COLLISION_MASK_PORTALFRAME);
 
-    // Update frame transforms to follow portal position/rotation/scale.
+    // Update frame transforms to follow portal position/orientation/scale.
     void updateFramesTransform();
 
 private:
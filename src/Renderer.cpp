@@ -48,8 +48,8 @@ void Renderer::drawScene(Scene &scene, Shader &shader, const glm::mat4 &view, co
 
     shader.setFloat("material.shininess", 32.0f);
 
-    for (auto &pair : scene.objects) {
-        pair.second->draw(shader);
+    for (const auto &obj : scene.objects) {
+        obj->draw(shader);
     }
 
     if (scene.skybox) {
@@ -121,8 +121,8 @@ void Renderer::render(Scene &scene, Camera &camera) {
     if (scene.portalB) scene.portalB->draw(*portalShader, *shader);
 
     
-    // for (auto &pair : scene.triggers) {
-    //     pair.second->drawOBBDebug(*shader);
+    // for (const auto &trigger : scene.triggers) {
+    //     trigger->drawOBBDebug(*shader);
     // }
     
     // 4. Draw Portal Gun
@@ -8,23 +8,55 @@
 #include "PhysicsSystem.h"
 #include "Player.h"
 #include "Trigger.h"
+#include "TriggerGrid.h"
 #include "Button.h"
 #include "Flip.h"
+#include "EntityStore.h"
+#include "Signal.h"
 
 #include <vector>
 #include <memory>
+#include <typeindex>
+#include <typeinfo>
+#include <type_traits>
 #include <unordered_map>
 
 #include <glm/glm.hpp>
 
 
 struct Scene {
+    // Pools for what gets created and destroyed during play. Declared first so they outlive
+    // every entity that lives in them.
+    ObjectPool<RigidBody> rigidBodyPool;
+    ObjectPool<AABB> colliderPool;
+    ObjectPool<Trigger> triggerPool;
+    std::unordered_map<std::type_index, std::unique_ptr<PoolArena>> objectPools; // One per GameObject type
+
     // Resource Management
-    std::unordered_map<std::string, std::unique_ptr<Model>> modelResources;
+    EntityStore<Model> modelResources;
 
     // Scene Graph
-    std::unordered_map<std::string, std::unique_ptr<GameObject>> objects;
-    std::unordered_map<std::string, std::unique_ptr<Trigger>> triggers;
+    // Handles stay valid across other removals; per-frame loops walk the dense arrays
+    EntityStore<GameObject> objects;
+    EntityStore<Trigger> triggers;
+
+    // Per-step logic runs per type: buttons and flips through their own lists with
+    // non-virtual calls, other GameObject subclasses through activeObjects. Plain
+    // GameObjects (walls, floors, cubes) have no logic and are in none of them.
+    std::vector<Button *> buttons;
+    std::vector<Flip *> flips;
+    std::vector<GameObject *> activeObjects;
+
+    // Trigger evaluation: the grid over the trigger bounds (trigger ids are dense indices into
+    // triggers) and the only objects tested against them (player, teleportable and dynamic
+    // objects) by dense body id. Ids of removed bodies are reused, null entries are free.
+    TriggerGrid triggerGrid;
+    std::vector<GameObject *> triggerBodies;
+    std::vector<uint32_t> freeTriggerBodyIds;
+    // Triggers each body was found inside this step, filled by the detection jobs
+    std::vector<std::vector<uint32_t>> triggerHits;
+    TriggerEventQueue triggerEvents;
+    static constexpr size_t TriggerGrainSize = 64;
 
     // Special Objects
     std::unique_ptr<Portal> portalA;
@@ -43,25 +75,211 @@ struct Scene {
     // Lighting
     glm::vec3 lightPos;
 
-    void addModelResource(const std::string &name, std::unique_ptr<Model> model) {
-        if (modelResources.count(name)) {
+    // Emitted when the level's goal is reached (wired by the level file)
+    Signal<> levelCompleted;
+
+    // Objects and triggers that belong to the loaded level, removed again by unloadLevel()
+    std::vector<EntityHandle> levelObjects;
+    std::vector<EntityHandle> levelTriggers;
+
+    EntityHandle addModelResource(const std::string &name, std::unique_ptr<Model> model) {
+        if (modelResources.contains(name)) {
             printf("Model resource %s already exists!\n", name.c_str());
-            return;
+            return EntityHandle();
+        }
+        return modelResources.add(name, std::move(model));
+    }
+
+    Model *getModel(const std::string &name) const {
+        return modelResources.find(name);
+    }
+
+    template <typename T>
+    ObjectPool<T> &objectPool() {
+        std::unique_ptr<PoolArena> &pool = objectPools[std::type_index(typeid(T))];
+        if (!pool) {
+            pool = std::make_unique<ObjectPool<T>>();
+        }
+        return static_cast<ObjectPool<T> &>(*pool);
+    }
+
+    // Makes room for count more spawned T with physics: the pools, the object store, the update
+    // and trigger lists and the physics body arrays, so spawning that many does not regrow them.
+    // Not covered: the ray trees are rebuilt after a spawn and new contacts grow the contact scratch.
+    template <typename T>
+    void reserveSpawns(size_t count) {
+        ObjectPool<T> &pool = objectPool<T>();
+        pool.reserve(pool.size() + count);
+        rigidBodyPool.reserve(rigidBodyPool.size() + count);
+        colliderPool.reserve(colliderPool.size() + count);
+        objects.reserve(objects.size() + count);
+        triggerBodies.reserve(triggerBodies.size() + count);
+        triggerHits.reserve(triggerBodies.capacity());
+        physicsSystem->reserve(physicsSystem->getBodyCount() + count);
+        // Same choice of list as addToUpdateList
+        if constexpr (std::is_base_of_v<Button, T>) {
+            buttons.reserve(buttons.size() + count);
+        } else if constexpr (std::is_base_of_v<Flip, T>) {
+            flips.reserve(flips.size() + count);
+        } else if constexpr (!std::is_same_v<T, GameObject>) {
+            activeObjects.reserve(activeObjects.size() + count);
         }
-        modelResources[name] = std::move(model);
     }
 
-    void addObject(std::string name, std::unique_ptr<GameObject> obj) {
-        if (objects.count(name)) {
+    // Builds a T in its pool and adds it as an anonymous object (reachable by handle only),
+    // e.g. the crates of a dropper. Give it a body with addPhysics.
+    template <typename T, typename... Args>
+    EntityHandle spawn(Args &&...args) {
+        return addObject("", objectPool<T>().create(std::forward<Args>(args)...));
+    }
+
+    // Removes a spawned object; its memory goes back to the pools for the next spawn
+    bool despawn(EntityHandle handle) {
+        return removeObject(handle);
+    }
+
+    EntityHandle addObject(std::string name, PoolPtr<GameObject> obj) {
+        if (objects.contains(name)) {
             printf("GameObject %s already exists!\n", name.c_str());
-            return;
+            return EntityHandle();
         }
         obj->name = name;
-        objects[name] = std::move(obj);
+        if (obj->isTeleportable || (obj->rigidBody && !obj->rigidBody->isStatic)) {
+            registerTriggerBody(obj.get());
+        }
+        if (obj->model) {
+            obj->model->retain();
+        }
+        addToUpdateList(obj.get());
+        GameObject *added = obj.get();
+        added->handle = objects.add(name, std::move(obj));
+        return added->handle;
+    }
+
+    void addToUpdateList(GameObject *obj) {
+        if (Button *button = dynamic_cast<Button *>(obj)) {
+            buttons.push_back(button);
+        } else if (Flip *flip = dynamic_cast<Flip *>(obj)) {
+            flips.push_back(flip);
+        } else if (typeid(*obj) != typeid(GameObject)) {
+            activeObjects.push_back(obj);
+        }
+    }
+
+    void removeFromUpdateList(GameObject *obj) {
+        auto eraseFrom = [](auto &list, GameObject *value) {
+            for (size_t i = 0; i < list.size(); ++i) {
+                if (list[i] != value) continue;
+                list[i] = list.back();
+                list.pop_back();
+                return;
+            }
+            };
+        eraseFrom(buttons, obj);
+        eraseFrom(flips, obj);
+        eraseFrom(activeObjects, obj);
+    }
+
+    // Takes the object out of physics, the triggers (firing their onExit), the portals and the
+    // player's grip, and destroys it
+    bool removeObject(EntityHandle handle) {
+        GameObject *obj = objects.get(handle);
+        if (!obj) return false;
+        closePortalsOn(obj);
+        if (player && player->grabbedObject == obj) {
+            player->grabbedObject = nullptr;
+            player->isGrabbing = false;
+        }
+        unregisterTriggerBody(obj);
+        if (obj->rigidBody) {
+            physicsSystem->removeObject(obj);
+        }
+        if (obj->model) {
+            obj->model->release();
+        }
+        removeFromUpdateList(obj);
+        return objects.remove(handle);
+    }
+
+    bool removeTrigger(EntityHandle handle) {
+        return triggers.remove(handle);
+    }
+
+    // Removes everything the level loader added. Triggers go first: their callbacks point at
+    // level objects (buttons) and must not run while those are being destroyed.
+    void unloadLevel() {
+        for (EntityHandle handle : levelTriggers) {
+            removeTrigger(handle);
+        }
+        for (EntityHandle handle : levelObjects) {
+            removeObject(handle);
+        }
+        levelTriggers.clear();
+        levelObjects.clear();
+    }
+
+    // Destroys the models no object references any more. Returns how many were unloaded.
+    size_t unloadUnusedModels() {
+        std::vector<EntityHandle> unused;
+        for (size_t i = 0; i < modelResources.size(); ++i) {
+            if (modelResources.values()[i]->getRefCount() == 0) {
+                unused.push_back(modelResources.handleAt(i));
+            }
+        }
+        for (EntityHandle handle : unused) {
+            modelResources.remove(handle);
+        }
+        return unused.size();
+    }
+
+    // Makes triggers test this object from now on
+    void registerTriggerBody(GameObject *obj) {
+        if (obj->triggerBodyId >= 0) return;
+        if (!freeTriggerBodyIds.empty()) {
+            obj->triggerBodyId = static_cast<int>(freeTriggerBodyIds.back());
+            freeTriggerBodyIds.pop_back();
+            triggerBodies[obj->triggerBodyId] = obj;
+        } else {
+            obj->triggerBodyId = static_cast<int>(triggerBodies.size());
+            triggerBodies.push_back(obj);
+        }
+    }
+
+    void unregisterTriggerBody(GameObject *obj) {
+        if (obj->triggerBodyId < 0) return;
+        uint32_t bodyId = static_cast<uint32_t>(obj->triggerBodyId);
+        for (const auto &trigger : triggers) {
+            if (trigger->releaseBody(bodyId) && trigger->onExit) {
+                trigger->onExit(obj);
+            }
+        }
+        triggerBodies[bodyId] = nullptr;
+        freeTriggerBodyIds.push_back(bodyId);
+        obj->triggerBodyId = -1;
     }
 
     void addPhysics(GameObject *obj, bool isStatic, uint32_t collisionMask = COLLISION_MASK_DEFAULT, float mass = 1.0f, float restitution = 0.2f, float friction = 0.5f) {
-        obj->rigidBody = std::make_unique<RigidBody>();
+        if (!obj->rigidBody) {
+            obj->rigidBody = rigidBodyPool.create();
+        }
+        if (!obj->collider) {
+            obj->collider = colliderPool.create(obj->model->minBound, obj->model->maxBound);
+        }
+        createPhysics(obj, isStatic, collisionMask, mass, restitution, friction);
+        physicsSystem->addObject(obj, obj->rigidBody.get(), obj->collider.get());
+        if (!isStatic) {
+            registerTriggerBody(obj);
+        }
+    }
+
+    // Builds the rigid body and collider without registering them anywhere, so loader threads can do it.
+    // Parts the object already has are reused; missing ones come from the heap (the pools are not thread safe).
+    static void createPhysics(GameObject *obj, bool isStatic, uint32_t collisionMask = COLLISION_MASK_DEFAULT, float mass = 1.0f, float restitution = 0.2f, float friction = 0.5f) {
+        if (obj->rigidBody) {
+            *obj->rigidBody = RigidBody();
+        } else {
+            obj->rigidBody = std::make_unique<RigidBody>();
+        }
         obj->rigidBody->isStatic = isStatic;
         obj->rigidBody->mass = mass;
         obj->rigidBody->restitution = restitution;
@@ -70,18 +288,91 @@ struct Scene {
         if (!obj->collider) {
             obj->collider = std::make_unique<AABB>(obj->model->minBound, obj->model->maxBound);
         }
-        physicsSystem->addObject(obj, obj->rigidBody.get(), obj->collider.get());
     }
 
-    void addTrigger(std::string name, std::unique_ptr<Trigger> trigger) {
-        if (triggers.count(name)) {
+    EntityHandle addTrigger(std::string name, PoolPtr<Trigger> trigger) {
+        if (triggers.contains(name)) {
             printf("Trigger %s already exists!\n", name.c_str());
-            return;
+            return EntityHandle();
         }
-        triggers[name] = std::move(trigger);
+        return triggers.add(name, std::move(trigger));
     }
 
+    // Tests the trigger bodies against the triggers in their grid cell, then runs the callbacks
+    void updateTriggers() {
+        if (player) {
+            registerTriggerBody(player.get());
+        }
+        const std::vector<PoolPtr<Trigger>> &triggerList = triggers.values();
+        triggerGrid.update(triggerList);
+
+        // Detection only reads trigger and body state, every body writes its own hit list
+        triggerHits.resize(triggerBodies.size());
+        physicsSystem->getJobSystem().parallelFor(triggerBodies.size(), TriggerGrainSize, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                std::vector<uint32_t> &hits = triggerHits[i];
+                hits.clear();
+                if (!triggerBodies[i]) continue;
+                const glm::vec3 &point = triggerBodies[i]->position;
+                triggerGrid.query(point, [&](uint32_t triggerId) {
+                    const Trigger *trigger = triggerList[triggerId].get();
+                    if (trigger->isActive && trigger->containsPoint(point)) {
+                        hits.push_back(triggerId);
+                    }
+                    });
+            }
+            });
+
+        for (size_t bodyId = 0; bodyId < triggerHits.size(); ++bodyId) {
+            for (uint32_t triggerId : triggerHits[bodyId]) {
+                triggerList[triggerId]->markInside(static_cast<uint32_t>(bodyId));
+            }
+        }
+        for (size_t triggerId = 0; triggerId < triggerList.size(); ++triggerId) {
+            triggerList[triggerId]->updateOccupancy(static_cast<uint32_t>(triggerId), triggerEvents);
+        }
+
+        triggerEvents.dispatch(triggerList, triggerBodies);
+    }
+
+    // Connects a signal to a method of a scene object. The target is looked up by handle when the
+    // signal fires, so removing the target leaves an inert link instead of a dangling pointer.
+    template <typename Target, typename... Args>
+    SignalConnection link(Signal<Args...> &signal, EntityHandle target, void (Target::*method)()) {
+        return signal.connect([this, target, method](Args...) {
+            if (GameObject *obj = objects.get(target)) {
+                if (Target *typed = dynamic_cast<Target *>(obj)) {
+                    (typed->*method)();
+                }
+            }
+            });
+    }
+
+    // Closes whichever portal sits on the surface (e.g. a wall that starts moving)
+    void closePortalsOn(GameObject *surface) {
+        if (!portalA || !portalB) return;
+        for (Portal *portal : { portalA.get(), portalB.get() }) {
+            if (portal->getOnObject() != surface) continue;
+            portal->setOnObject(nullptr);
+            portal->isActive = false;
+            portal->position = glm::vec3(100.0f, 0.0f, 100.0f);
+            portalA->getNearTrigger()->isActive = false;
+            portalA->getTeleportTrigger()->isActive = false;
+            portalB->getNearTrigger()->isActive = false;
+            portalB->getTeleportTrigger()->isActive = false;
+        }
+    }
+
+    // Advances the simulation by one fixed step
     void update(float dt, const Camera &camera) {
+        // Remember the pose at the start of the step for render interpolation
+        if (player) {
+            player->storePreviousTransform();
+        }
+        for (const auto &obj : objects) {
+            obj->storePreviousTransform();
+        }
+
         // Update Physics
         if (physicsSystem) {
             physicsSystem->update(dt);
@@ -91,68 +382,35 @@ struct Scene {
             player->update(dt, physicsSystem.get());
         }
 
-        for (auto &pair : objects) {
-            pair.second->update(dt, camera);
+        // Buttons first so flips linked to them react within the same step
+        for (Button *button : buttons) {
+            button->Button::update(dt, camera);
         }
-
-        if (portalGun) {
-            portalGun->update(dt, camera);
+        for (Flip *flip : flips) {
+            flip->Flip::update(dt, camera);
+        }
+        for (GameObject *obj : activeObjects) {
+            obj->update(dt, camera);
         }
 
-        for (auto &pair : triggers) {
-            if (player) {
-                pair.second->check(player.get());
-            }
-            for (auto &objPair : objects) {
-                pair.second->check(objPair.second.get());
-            }
+        updateTriggers();
+    }
+
+    // Per rendered frame: blends every object between its last two fixed steps.
+    // alpha is the fraction of a step left in the accumulator.
+    void updateFrame(float dt, float alpha, Camera &camera) {
+        for (const auto &obj : objects) {
+            obj->interpolateRenderTransform(alpha);
         }
 
-        auto button_flip = objects.find("button_flip");
-        if (button_flip != objects.end()) {
-            Button *btn = dynamic_cast<Button *>(button_flip->second.get());
-            if (btn && btn->getIsPressed()) {
-                auto flipWall = objects.find("flip_wall");
-                if (flipWall != objects.end()) {
-                    Flip *flip = dynamic_cast<Flip *>(flipWall->second.get());
-                    if (flip) {
-                        flip->flip();
-                    }
-                }
-            } else if (btn && btn->getIsReleased()) {
-                auto flipWall = objects.find("flip_wall");
-                if (flipWall != objects.end()) {
-                    Flip *flip = dynamic_cast<Flip *>(flipWall->second.get());
-                    if (flip) {
-                        flip->reset();
-                    }
-                }
-            }
+        if (player) {
+            glm::vec3 position = player->previousPosition + (player->position - player->previousPosition) * alpha;
+            player->camera.Position = position + glm::vec3(0.0f, player->height * 0.4f, 0.0f);
         }
 
-        auto flip_wall = objects.find("flip_wall");
-        if (flip_wall != objects.end()) {
-            Flip *flip = dynamic_cast<Flip *>(flip_wall->second.get());
-            if (flip && flip->getIsRotating()) {
-                if (portalA->getOnObject() == flip) {
-                    portalA->setOnObject(nullptr);
-                    portalA->isActive = false;
-                    portalA->position = glm::vec3(100.0f, 0.0f, 100.0f);
-                    portalA->getNearTrigger()->isActive = false;
-                    portalA->getTeleportTrigger()->isActive = false;
-                    portalB->getNearTrigger()->isActive = false;
-                    portalB->getTeleportTrigger()->isActive = false;
-                }
-                if (portalB->getOnObject() == flip) {
-                    portalB->setOnObject(nullptr);
-                    portalB->isActive = false;
-                    portalB->position = glm::vec3(100.0f, 0.0f, 100.0f);
-                    portalA->getNearTrigger()->isActive = false;
-                    portalA->getTeleportTrigger()->isActive = false;
-                    portalB->getNearTrigger()->isActive = false;
-                    portalB->getTeleportTrigger()->isActive = false;
-                }
-            }
+        // The gun follows the interpolated camera, so it is updated per frame rather than per step
+        if (portalGun) {
+            portalGun->update(dt, camera);
         }
     }
 };
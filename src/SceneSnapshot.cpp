@@ -0,0 +1,312 @@
+#include "SceneSnapshot.h"
+#include "Button.h"
+#include "Flip.h"
+#include "Scene.h"
+
+#include <cstring>
+#include <type_traits>
+
+namespace {
+
+constexpr uint32_t SNAPSHOT_MAGIC = 0x50534e53; // "SNSP"
+
+enum class ObjectKind : uint8_t {
+    Object,
+    Button,
+    Flip
+};
+
+enum ObjectFlags : uint8_t {
+    ObjectFlagCanOpenPortal = 1 << 0,
+    ObjectFlagHasBody = 1 << 1,
+    ObjectFlagOnGround = 1 << 2
+};
+
+struct SnapshotHeader {
+    uint32_t magic;
+    uint32_t objectCount;
+    uint32_t triggerCount;
+    uint8_t hasPortals;
+    uint8_t hasPlayer;
+    uint16_t padding;
+};
+
+// Followed by a Button::State or Flip::State depending on kind
+struct ObjectRecord {
+    EntityHandle handle;
+    glm::vec3 position;
+    glm::quat orientation;
+    glm::vec3 scale;
+    glm::vec3 velocity;
+    uint32_t collisionMask;
+    ObjectKind kind;
+    uint8_t flags; // ObjectFlags
+    uint16_t padding;
+};
+
+// Followed by wordCount occupancy words
+struct TriggerRecord {
+    EntityHandle handle;
+    OBB bounds;
+    uint32_t wordCount;
+    uint8_t isActive;
+    uint8_t padding[3];
+};
+
+struct PortalRecord {
+    glm::vec3 position;
+    glm::quat orientation;
+    glm::vec3 scale;
+    EntityHandle onObject;
+    uint8_t isActive;
+    uint8_t padding[3];
+};
+
+struct PlayerRecord {
+    glm::vec3 position;
+    glm::quat orientation;
+    glm::vec3 velocity;
+    glm::vec3 cameraFront;
+    glm::vec3 cameraUp;
+    glm::vec3 cameraRight;
+    float cameraYaw;
+    float cameraPitch;
+    float cameraRoll;
+    float rollRecoveryTimer;
+    float rollRecoveryDuration;
+    float initialRoll;
+    EntityHandle grabbedObject;
+    uint8_t isGrounded;
+    uint8_t isGrabbing;
+    uint16_t padding;
+};
+
+template <typename T>
+void write(std::vector<uint8_t> &out, const T *values, size_t count = 1) {
+    static_assert(std::is_trivially_copyable<T>::value, "snapshot records are copied as bytes");
+    size_t offset = out.size();
+    out.resize(offset + sizeof(T) * count);
+    std::memcpy(out.data() + offset, values, sizeof(T) * count);
+}
+
+// Reads records back in the order they were written, failing once the data runs out
+class Reader {
+public:
+    explicit Reader(const std::vector<uint8_t> &data) : data(data) {}
+
+    template <typename T>
+    bool read(T &value) {
+        if (data.size() - offset < sizeof(T)) return false;
+        std::memcpy(&value, data.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    // Points at count values of T inside the data, or null
+    template <typename T>
+    const T *view(size_t count) {
+        if ((data.size() - offset) / sizeof(T) < count) return nullptr;
+        const T *values = reinterpret_cast<const T *>(data.data() + offset);
+        offset += sizeof(T) * count;
+        return values;
+    }
+
+private:
+    const std::vector<uint8_t> &data;
+    size_t offset = 0;
+};
+
+// Spawned objects have no name, so references go by the object's own handle
+EntityHandle handleOf(const Scene &scene, const GameObject *obj) {
+    return obj && scene.objects.get(obj->handle) == obj ? obj->handle : EntityHandle();
+}
+
+} // namespace
+
+void SceneSnapshot::capture(const Scene &scene) {
+    data.clear();
+
+    SnapshotHeader header = {};
+    header.magic = SNAPSHOT_MAGIC;
+    header.objectCount = static_cast<uint32_t>(scene.objects.size());
+    header.triggerCount = static_cast<uint32_t>(scene.triggers.size());
+    header.hasPortals = scene.portalA && scene.portalB;
+    header.hasPlayer = scene.player != nullptr;
+    write(data, &header);
+
+    const auto &objects = scene.objects.values();
+    for (size_t i = 0; i < objects.size(); ++i) {
+        const GameObject *obj = objects[i].get();
+        ObjectRecord record = {};
+        record.handle = scene.objects.handleAt(i);
+        record.position = obj->position;
+        record.orientation = obj->orientation;
+        record.scale = obj->scale;
+        record.flags = obj->canOpenPortal ? ObjectFlagCanOpenPortal : 0;
+        if (obj->rigidBody) {
+            record.velocity = obj->rigidBody->velocity;
+            record.collisionMask = obj->rigidBody->collisionMask;
+            record.flags |= ObjectFlagHasBody;
+            if (obj->rigidBody->isOnGround) record.flags |= ObjectFlagOnGround;
+        }
+
+        const Button *button = dynamic_cast<const Button *>(obj);
+        const Flip *flip = button ? nullptr : dynamic_cast<const Flip *>(obj);
+        record.kind = button ? ObjectKind::Button : flip ? ObjectKind::Flip : ObjectKind::Object;
+        write(data, &record);
+        if (button) {
+            Button::State state = button->getState();
+            write(data, &state);
+        } else if (flip) {
+            Flip::State state = flip->getState();
+            write(data, &state);
+        }
+    }
+
+    const auto &triggers = scene.triggers.values();
+    for (size_t i = 0; i < triggers.size(); ++i) {
+        const Trigger *trigger = triggers[i].get();
+        const std::vector<uint64_t> &occupancy = trigger->getOccupancy();
+        TriggerRecord record = {};
+        record.handle = scene.triggers.handleAt(i);
+        record.bounds = trigger->getBounds();
+        record.wordCount = static_cast<uint32_t>(occupancy.size());
+        record.isActive = trigger->isActive;
+        write(data, &record);
+        write(data, occupancy.data(), occupancy.size());
+    }
+
+    if (header.hasPortals) {
+        for (const Portal *portal : { scene.portalA.get(), scene.portalB.get() }) {
+            PortalRecord record = {};
+            record.position = portal->position;
+            record.orientation = portal->orientation;
+            record.scale = portal->scale;
+            record.onObject = handleOf(scene, portal->getOnObject());
+            record.isActive = portal->isActive;
+            write(data, &record);
+        }
+    }
+
+    if (header.hasPlayer) {
+        const Player &player = *scene.player;
+        PlayerRecord record = {};
+        record.position = player.position;
+        record.orientation = player.orientation;
+        record.velocity = player.rigidBody ? player.rigidBody->velocity : glm::vec3(0.0f);
+        record.cameraFront = player.camera.Front;
+        record.cameraUp = player.camera.Up;
+        record.cameraRight = player.camera.Right;
+        record.cameraYaw = player.camera.Yaw;
+        record.cameraPitch = player.camera.Pitch;
+        record.cameraRoll = player.camera.Roll;
+        record.rollRecoveryTimer = player.rollRecoveryTimer;
+        record.rollRecoveryDuration = player.rollRecoveryDuration;
+        record.initialRoll = player.initialRoll;
+        record.grabbedObject = handleOf(scene, player.grabbedObject);
+        record.isGrounded = player.isGrounded;
+        record.isGrabbing = player.isGrabbing;
+        write(data, &record);
+    }
+}
+
+bool SceneSnapshot::restore(Scene &scene) const {
+    Reader reader(data);
+    SnapshotHeader header;
+    if (!reader.read(header) || header.magic != SNAPSHOT_MAGIC) return false;
+
+    for (uint32_t i = 0; i < header.objectCount; ++i) {
+        ObjectRecord record;
+        if (!reader.read(record)) return false;
+        GameObject *obj = scene.objects.get(record.handle);
+
+        Button::State buttonState;
+        Flip::State flipState;
+        if (record.kind == ObjectKind::Button && !reader.read(buttonState)) return false;
+        if (record.kind == ObjectKind::Flip && !reader.read(flipState)) return false;
+        if (!obj) continue;
+
+        obj->position = record.position;
+        obj->orientation = record.orientation;
+        obj->scale = record.scale;
+        obj->canOpenPortal = (record.flags & ObjectFlagCanOpenPortal) != 0;
+        obj->storePreviousTransform();
+        obj->interpolateRenderTransform(1.0f);
+        if (obj->rigidBody && (record.flags & ObjectFlagHasBody)) {
+            obj->rigidBody->velocity = record.velocity;
+            obj->rigidBody->collisionMask = record.collisionMask;
+            obj->rigidBody->isOnGround = (record.flags & ObjectFlagOnGround) != 0;
+            obj->rigidBody->clearForces();
+            obj->rigidBody->wake();
+        }
+        // The kind was checked when capturing and the handle still points at the same entity
+        if (record.kind == ObjectKind::Button) {
+            static_cast<Button *>(obj)->setState(buttonState);
+        } else if (record.kind == ObjectKind::Flip) {
+            static_cast<Flip *>(obj)->setState(flipState);
+        }
+    }
+
+    for (uint32_t i = 0; i < header.triggerCount; ++i) {
+        TriggerRecord record;
+        if (!reader.read(record)) return false;
+        const uint64_t *occupancy = reader.view<uint64_t>(record.wordCount);
+        if (!occupancy) return false;
+        Trigger *trigger = scene.triggers.get(record.handle);
+        if (!trigger) continue;
+
+        // Changing the bounds rebuilds the trigger grid, so only do it for triggers that moved
+        if (std::memcmp(&record.bounds, &trigger->getBounds(), sizeof(OBB)) != 0) {
+            trigger->setBounds(record.bounds);
+        }
+        trigger->isActive = record.isActive != 0;
+        trigger->setOccupancy(occupancy, record.wordCount);
+    }
+
+    if (header.hasPortals) {
+        for (Portal *portal : { scene.portalA.get(), scene.portalB.get() }) {
+            PortalRecord record;
+            if (!reader.read(record)) return false;
+            if (!portal) continue;
+            portal->position = record.position;
+            portal->orientation = record.orientation;
+            portal->scale = record.scale;
+            portal->isActive = record.isActive != 0;
+            portal->setOnObject(scene.objects.get(record.onObject));
+            portal->storePreviousTransform();
+            portal->interpolateRenderTransform(1.0f);
+            portal->updateFramesTransform();
+        }
+    }
+
+    if (header.hasPlayer) {
+        PlayerRecord record;
+        if (!reader.read(record)) return false;
+        if (scene.player) {
+            Player &player = *scene.player;
+            player.position = record.position;
+            player.orientation = record.orientation;
+            if (player.rigidBody) {
+                player.rigidBody->velocity = record.velocity;
+            }
+            player.camera.Front = record.cameraFront;
+            player.camera.Up = record.cameraUp;
+            player.camera.Right = record.cameraRight;
+            player.camera.Yaw = record.cameraYaw;
+            player.camera.Pitch = record.cameraPitch;
+            player.camera.Roll = record.cameraRoll;
+            player.rollRecoveryTimer = record.rollRecoveryTimer;
+            player.rollRecoveryDuration = record.rollRecoveryDuration;
+            player.initialRoll = record.initialRoll;
+            player.grabbedObject = scene.objects.get(record.grabbedObject);
+            player.isGrounded = record.isGrounded != 0;
+            player.isGrabbing = record.isGrabbing != 0 && player.grabbedObject;
+            player.storePreviousTransform();
+        }
+    }
+
+    if (scene.physicsSystem) {
+        scene.physicsSystem->resetContacts();
+    }
+    return true;
+}
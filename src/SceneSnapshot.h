@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Scene;
+
+// Binary copy of everything in a scene that changes while playing: object transforms and
+// velocities, button and flip state, trigger bounds and occupancy, portal placement and the
+// player. Static data (models, colliders, masses, links) is not stored, so a snapshot only
+// restores into the scene it was captured from, with the same level loaded.
+//
+// The data is a flat array of fixed-size records copied in and out with memcpy; capturing
+// again reuses the buffer, so checkpoints cost no allocation once the first one is taken.
+class SceneSnapshot {
+public:
+    void capture(const Scene &scene);
+
+    // Puts the scene back into the captured state. Entities removed since the capture are
+    // skipped, ones added since are left as they are. Returns false if nothing was captured.
+    // Cached physics contacts are dropped and every body starts awake, so the following steps
+    // match the original run up to solver warm starting.
+    bool restore(Scene &scene) const;
+
+    bool isEmpty() const { return data.empty(); }
+    void clear() { data.clear(); }
+    // Bytes used
+    size_t size() const { return data.size(); }
+
+private:
+    std::vector<uint8_t> data;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+// Identifies one slot of a Signal so it can be disconnected again. 0 is never handed out.
+struct SignalConnection {
+    uint32_t id = 0;
+
+    bool isValid() const { return id != 0; }
+};
+
+// Minimal signal/slot: gameplay objects publish events (a button was pressed) and the level
+// connects whatever should react to them once, at load, instead of polling every frame.
+// Slots run in connection order. They must not connect or disconnect slots of the same signal.
+template <typename... Args>
+class Signal {
+public:
+    using Slot = std::function<void(Args...)>;
+
+    SignalConnection connect(Slot slot) {
+        SignalConnection connection{ ++lastId };
+        slots.push_back({ connection.id, std::move(slot) });
+        return connection;
+    }
+
+    void disconnect(SignalConnection connection) {
+        for (size_t i = 0; i < slots.size(); ++i) {
+            if (slots[i].first == connection.id) {
+                slots.erase(slots.begin() + i);
+                return;
+            }
+        }
+    }
+
+    void disconnectAll() { slots.clear(); }
+
+    bool empty() const { return slots.empty(); }
+
+    void emit(Args... args) const {
+        for (const auto &slot : slots) {
+            slot.second(args...);
+        }
+    }
+
+private:
+    std::vector<std::pair<uint32_t, Slot>> slots;
+    uint32_t lastId = 0;
+};
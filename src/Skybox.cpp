@@ -5,10 +5,17 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
-Skybox::Skybox(const std::vector<std::string> &faces) {
+Skybox::Skybox(const std::vector<std::string> &faces, ModelUpload upload) : facePaths(faces) {
     shader = new Shader("shaders/skybox.vert", "shaders/skybox.frag");
     setupMesh();
-    loadCubemap(faces);
+    setupTexture();
+    if (upload != ModelUpload::Async) {
+        decodeFaces();
+    }
+    if (upload == ModelUpload::Immediate) {
+        while (!uploadStep()) {
+        }
+    }
 }
 
 Skybox::~Skybox() {
@@ -18,41 +25,59 @@ Skybox::~Skybox() {
     delete shader;
 }
 
-void Skybox::loadCubemap(const std::vector<std::string> &faces) {
+void Skybox::setupTexture() {
     glGenTextures(1, &textureID);
     glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+}
 
-    int width, height, nrChannels;
-    stbi_set_flip_vertically_on_load(false);
-
-    for (unsigned int i = 0; i < faces.size(); i++) {
-        unsigned char *data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
+void Skybox::decodeFaces() {
+    // Cubemap faces are not flipped. Only this thread's setting changes, so model textures
+    // decoded on other threads at the same time keep flipping.
+    stbi_set_flip_vertically_on_load_thread(false);
+
+    faceImages.resize(facePaths.size());
+    for (size_t i = 0; i < facePaths.size(); i++) {
+        ImageData &image = faceImages[i];
+        image.path = facePaths[i];
+        int nrChannels;
+        // Loaded as RGBA like the model textures, which also keeps every row 4-byte aligned
+        unsigned char *data = stbi_load(facePaths[i].c_str(), &image.width, &image.height, &nrChannels, 4);
         if (data) {
-            GLenum format = GL_RGB;
-            if (nrChannels == 1)
-                format = GL_RED;
-            else if (nrChannels == 3)
-                format = GL_RGB;
-            else if (nrChannels == 4)
-                format = GL_RGBA;
-
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
-                0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data
-            );
+            image.pixels.assign(data, data + static_cast<size_t>(image.width) * image.height * 4);
             stbi_image_free(data);
         } else {
-            std::cout << "Cubemap texture failed to load at path: " << faces[i] << std::endl;
-            stbi_image_free(data);
+            std::cout << "Cubemap texture failed to load at path: " << facePaths[i] << std::endl;
         }
     }
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 
-    // Restore flip setting
-    stbi_set_flip_vertically_on_load(true);
+    // Back to the flip the model textures use
+    stbi_set_flip_vertically_on_load_thread(true);
+}
+
+bool Skybox::uploadStep() {
+    if (uploadedFaces < faceImages.size()) {
+        const ImageData &image = faceImages[uploadedFaces];
+        if (!image.pixels.empty()) {
+            glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + static_cast<GLenum>(uploadedFaces),
+                0, GL_RGBA, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels.data()
+            );
+        }
+        // Pixels are on the GPU now
+        faceImages[uploadedFaces] = ImageData();
+        uploadedFaces++;
+    }
+
+    if (isUploaded()) {
+        faceImages.clear();
+        return true;
+    }
+    return false;
 }
 
 void Skybox::setupMesh() {
@@ -111,6 +136,8 @@ void Skybox::setupMesh() {
 }
 
 void Skybox::draw(const glm::mat4 &view, const glm::mat4 &projection) {
+    if (!isUploaded()) return;
+
     glDepthFunc(GL_LEQUAL);  // change depth function so depth test passes when values are equal to depth buffer's content
     shader->use();
 
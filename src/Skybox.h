@@ -1,5 +1,7 @@
 #pragma once
+#include "Model.h"
 #include "Shader.h"
+#include "Texture.h"
 
 #include <vector>
 #include <string>
@@ -9,9 +11,18 @@
 
 class Skybox {
 public:
-    Skybox(const std::vector<std::string> &faces);
+    // The faces load like a model's meshes (see ModelUpload): Immediate decodes and uploads them
+    // here, Deferred only decodes them, Async leaves decodeFaces() to the caller as well.
+    Skybox(const std::vector<std::string> &faces, ModelUpload upload = ModelUpload::Immediate);
     ~Skybox();
 
+    // Loads the face images; no GL, any thread
+    void decodeFaces();
+    // Uploads one decoded face. Returns true once all of them are on the GPU.
+    bool uploadStep();
+    bool isUploaded() const { return uploadedFaces == facePaths.size(); }
+
+    // Draws nothing until every face is uploaded
     void draw(const glm::mat4 &view, const glm::mat4 &projection);
 
 private:
@@ -19,6 +30,10 @@ private:
     unsigned int VAO, VBO;
     Shader *shader;
 
-    void loadCubemap(const std::vector<std::string> &faces);
+    std::vector<std::string> facePaths;
+    std::vector<ImageData> faceImages; // Decoded faces waiting for upload
+    size_t uploadedFaces = 0;
+
+    void setupTexture();
     void setupMesh();
 };
@@ -41,33 +41,54 @@ Texture::Texture(const char *path, const std::string &directory, const std::stri
     this->ID = TextureFromFile(path, directory);
 }
 
+Texture::Texture(const ImageData &image, const std::string &typeName) {
+    this->type = typeName;
+    this->path = image.path;
+    this->ID = UploadImage(image);
+}
+
 unsigned int Texture::TextureFromFile(const char *path, const std::string &directory, bool gamma) {
-    std::string filename = std::string(path);
-    filename = directory + '/' + filename;
+    ImageData image;
+    DecodeFile(path, directory, image);
+    return UploadImage(image);
+}
 
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
+bool Texture::DecodeFile(const char *path, const std::string &directory, ImageData &out) {
+    out.path = path;
+    std::string filename = directory + '/' + std::string(path);
 
     int width, height, nrComponents;
     // Force loading as RGBA to avoid alignment issues and simplify format handling
     unsigned char *data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 4);
-    if (data) {
+    if (!data) {
+        std::cout << "Texture failed to load at path: " << filename << std::endl;
+        out.pixels.clear();
+        return false;
+    }
+
+    out.width = width;
+    out.height = height;
+    out.pixels.assign(data, data + static_cast<size_t>(width) * height * 4);
+    stbi_image_free(data);
+    return true;
+}
+
+unsigned int Texture::UploadImage(const ImageData &image) {
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+
+    if (!image.pixels.empty()) {
         GLenum format = GL_RGBA;
 
         glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.pixels.data());
         glGenerateMipmap(GL_TEXTURE_2D);
 
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
     } else {
-        std::cout << "Texture failed to load at path: " << filename << std::endl;
-        stbi_image_free(data);
-
         // Use checkerboard pattern for failed textures
         glBindTexture(GL_TEXTURE_2D, textureID);
         unsigned char pixels[] = {
@@ -1,9 +1,19 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include <glad/gl.h>
 
+// Decoded RGBA8 image. Decoding needs no GL context, so it can happen on a loader thread
+// and the upload later on the GL thread.
+struct ImageData {
+    std::string path; // As written in the material, the Texture keeps it for deduplication
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> pixels; // Empty if the file could not be decoded
+};
+
 class Texture {
 public:
     unsigned int ID;
@@ -11,9 +21,16 @@ public:
     std::string path;
 
     Texture(const char *path, const std::string &directory, const std::string &typeName = "texture_diffuse");
+    // Uploads an image decoded earlier with DecodeFile
+    Texture(const ImageData &image, const std::string &typeName = "texture_diffuse");
     // Helper for loading texture from path
     static unsigned int TextureFromFile(const char *path, const std::string &directory, bool gamma = false);
 
+    // CPU half of TextureFromFile, safe to call from any thread. Returns false if the file can not be decoded.
+    static bool DecodeFile(const char *path, const std::string &directory, ImageData &out);
+    // GL half of TextureFromFile; an image that failed to decode becomes the checkerboard
+    static unsigned int UploadImage(const ImageData &image);
+
     // Default textures
     static unsigned int WhiteTexture;
     static unsigned int CheckerboardTexture;
@@ -0,0 +1,74 @@
+#include "Transform.h"
+
+#include <algorithm>
+#include <cmath>
+
+bool Transform::update(const glm::vec3 &position, const glm::quat &orientation, const glm::vec3 &scale) {
+    if (!dirty && position == cachedPosition && orientation == cachedOrientation && scale == cachedScale) {
+        return false;
+    }
+
+    if (dirty || orientation != cachedOrientation) {
+        basis = glm::mat3_cast(orientation);
+    }
+    cachedPosition = position;
+    cachedOrientation = orientation;
+    cachedScale = scale;
+    dirty = false;
+    version++;
+
+    rigidMatrix = glm::mat4(basis);
+    rigidMatrix[3] = glm::vec4(position, 1.0f);
+
+    matrix = rigidMatrix;
+    matrix[0] *= scale.x;
+    matrix[1] *= scale.y;
+    matrix[2] *= scale.z;
+
+    // Inverse of a rotation + translation: transpose the basis, rotate the translation back
+    glm::mat3 inverseBasis = glm::transpose(basis);
+    inverseRigidMatrix = glm::mat4(inverseBasis);
+    inverseRigidMatrix[3] = glm::vec4(-(inverseBasis * position), 1.0f);
+    return true;
+}
+
+glm::quat Transform::eulerToQuat(const glm::vec3 &degrees, EulerOrder order) {
+    glm::vec3 r = glm::radians(degrees);
+    glm::quat qx = glm::angleAxis(r.x, glm::vec3(1.0f, 0.0f, 0.0f));
+    glm::quat qy = glm::angleAxis(r.y, glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::quat qz = glm::angleAxis(r.z, glm::vec3(0.0f, 0.0f, 1.0f));
+
+    if (order == EulerOrder::YXZ) {
+        return qy * qx * qz;
+    }
+    return qx * qy * qz;
+}
+
+glm::vec3 Transform::quatToEuler(const glm::quat &orientation, EulerOrder order) {
+    glm::mat3 m = glm::mat3_cast(orientation);
+    // m[column][row]; angles are read off the rotation matrix of the given order
+    float x, y, z;
+    if (order == EulerOrder::YXZ) {
+        // R = Ry * Rx * Rz: R[2][1] = -sin(x)
+        x = std::asin(-std::clamp(m[2][1], -1.0f, 1.0f));
+        if (std::abs(m[2][1]) < 0.9999f) {
+            y = std::atan2(m[2][0], m[2][2]);
+            z = std::atan2(m[0][1], m[1][1]);
+        } else {
+            // Gimbal lock, put everything into y
+            y = std::atan2(-m[0][2], m[0][0]);
+            z = 0.0f;
+        }
+    } else {
+        // R = Rx * Ry * Rz: R[2][0] = sin(y)
+        y = std::asin(std::clamp(m[2][0], -1.0f, 1.0f));
+        if (std::abs(m[2][0]) < 0.9999f) {
+            x = std::atan2(-m[2][1], m[2][2]);
+            z = std::atan2(-m[1][0], m[0][0]);
+        } else {
+            x = std::atan2(m[1][2], m[1][1]);
+            z = 0.0f;
+        }
+    }
+    return glm::degrees(glm::vec3(x, y, z));
+}
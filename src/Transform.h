@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// Order in which Euler angles (degrees) are applied, for converting to and from the editor view.
+// Objects authored in levels use R = Rx * Ry * Rz, portals use R = Ry * Rx * Rz so yaw and
+// pitch follow the surface normal.
+enum class EulerOrder {
+    XYZ,
+    YXZ
+};
+
+// Cached world transform of an object.
+// Position, orientation and scale stay plain fields on the owner; update() compares them with the
+// values the cache was built from and only rebuilds the matrices when one changed.
+class Transform {
+public:
+    // Rebuilds the cached matrices if any input changed. Returns true if they were rebuilt.
+    bool update(const glm::vec3 &position, const glm::quat &orientation, const glm::vec3 &scale);
+
+    // Forces the next update() to rebuild
+    void markDirty() { dirty = true; }
+
+    // Rotation basis, columns are the local right, up and forward axes in world space
+    const glm::mat3 &getBasis() const { return basis; }
+    glm::vec3 getRight() const { return basis[0]; }
+    glm::vec3 getUp() const { return basis[1]; }
+    glm::vec3 getForward() const { return basis[2]; }
+
+    // translate * rotate * scale
+    const glm::mat4 &getMatrix() const { return matrix; }
+    // translate * rotate, i.e. the matrix without scale (portal views use this)
+    const glm::mat4 &getRigidMatrix() const { return rigidMatrix; }
+    const glm::mat4 &getInverseRigidMatrix() const { return inverseRigidMatrix; }
+
+    // Incremented every time the cache is rebuilt, lets other systems notice movement cheaply
+    uint32_t getVersion() const { return version; }
+
+    static glm::quat eulerToQuat(const glm::vec3 &degrees, EulerOrder order);
+    static glm::vec3 quatToEuler(const glm::quat &orientation, EulerOrder order);
+
+private:
+    bool dirty = true;
+    uint32_t version = 0;
+
+    glm::vec3 cachedPosition = glm::vec3(0.0f);
+    glm::quat cachedOrientation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    glm::vec3 cachedScale = glm::vec3(1.0f);
+
+    glm::mat3 basis = glm::mat3(1.0f);
+    glm::mat4 matrix = glm::mat4(1.0f);
+    glm::mat4 rigidMatrix = glm::mat4(1.0f);
+    glm::mat4 inverseRigidMatrix = glm::mat4(1.0f);
+};
@@ -1,6 +1,7 @@
 #include "Trigger.h"
 #include "GameObject.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include <glad/gl.h>
@@ -8,23 +9,50 @@
 
 Trigger::Trigger(const OBB &obb) : bounds(obb) {}
 
-void Trigger::check(GameObject *obj) {
-    if (!isActive || !obj) return;
+void Trigger::markInside(uint32_t bodyId) {
+    size_t word = bodyId / 64;
+    if (word >= nextInsideBits.size()) {
+        nextInsideBits.resize(word + 1, 0);
+    }
+    nextInsideBits[word] |= uint64_t(1) << (bodyId % 64);
+}
 
-    bool inside = isPointInside(obj->position);
-    bool wasInside = objectsInside.count(obj) > 0;
+void Trigger::updateOccupancy(uint32_t triggerId, TriggerEventQueue &events) {
+    // Inactive triggers keep their occupancy until they are switched back on
+    if (!isActive) return;
 
-    if (inside && !wasInside) {
-        objectsInside.insert(obj);
-        if (onEnter) onEnter(obj);
-    } else if (!inside && wasInside) {
-        objectsInside.erase(obj);
-        if (onExit) onExit(obj);
+    size_t wordCount = std::max(insideBits.size(), nextInsideBits.size());
+    insideBits.resize(wordCount, 0);
+    nextInsideBits.resize(wordCount, 0);
+
+    for (size_t word = 0; word < wordCount; ++word) {
+        uint64_t was = insideBits[word];
+        uint64_t now = nextInsideBits[word];
+        uint64_t changed = was | now;
+        for (uint32_t bit = 0; changed != 0; ++bit, changed >>= 1) {
+            if (!(changed & 1)) continue;
+            uint64_t mask = uint64_t(1) << bit;
+            TriggerEventType type = !(now & mask) ? TriggerEventType::Exit
+                : (was & mask) ? TriggerEventType::Inside : TriggerEventType::Enter;
+            events.push({ triggerId, static_cast<uint32_t>(word * 64 + bit), type });
+        }
+        insideBits[word] = now;
+        nextInsideBits[word] = 0;
     }
+}
 
-    if (inside && onInside) {
-        onInside(obj);
-    }
+bool Trigger::releaseBody(uint32_t bodyId) {
+    size_t word = bodyId / 64;
+    uint64_t bit = uint64_t(1) << (bodyId % 64);
+    bool wasInside = word < insideBits.size() && (insideBits[word] & bit) != 0;
+    if (word < insideBits.size()) insideBits[word] &= ~bit;
+    if (word < nextInsideBits.size()) nextInsideBits[word] &= ~bit;
+    return wasInside;
+}
+
+void Trigger::setOccupancy(const uint64_t *words, size_t wordCount) {
+    insideBits.assign(words, words + wordCount);
+    std::fill(nextInsideBits.begin(), nextInsideBits.end(), 0);
 }
 
 void Trigger::drawOBBDebug(Shader &shader) {
@@ -95,7 +123,7 @@ void Trigger::drawOBBDebug(Shader &shader) {
     glBindVertexArray(0);
 }
 
-bool Trigger::isPointInside(const glm::vec3 &point) const {
+bool Trigger::containsPoint(const glm::vec3 &point) const {
     // Transform point to OBB local space
     glm::vec3 d = point - bounds.center;
 
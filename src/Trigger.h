@@ -1,9 +1,11 @@
 #pragma once
 #include "PhysicsSystem.h"
 #include "Shader.h"
+#include "TriggerEvents.h"
 
-#include <unordered_set>
+#include <cstdint>
 #include <functional>
+#include <vector>
 
 #include <glm/glm.hpp>
 
@@ -23,29 +25,50 @@ public:
         bounds = OBB(center, axes, halfExtents);
     }
 
-    OBB bounds;
     bool isActive = true;
 
     // Callbacks
-    // Pass the object pointer that triggered it.
+    // Pass the object pointer that triggered it. They run in TriggerEventQueue::dispatch,
+    // after every trigger has been evaluated for the step.
     std::function<void(GameObject *obj)> onEnter;
     std::function<void(GameObject *obj)> onExit;
     std::function<void(GameObject *obj)> onInside;
 
-    // Check a specific object
-    void check(GameObject *obj);
+    // Occupancy is tracked per dense body id (see Scene::registerTriggerBody).
+    // Each step: markInside() for every body found inside, then updateOccupancy() compares
+    // with the previous step and records the enter/inside/exit events.
+    bool containsPoint(const glm::vec3 &point) const;
+    void markInside(uint32_t bodyId);
+    void updateOccupancy(uint32_t triggerId, TriggerEventQueue &events);
+    // Forgets a body that is being removed. Returns true if it was inside.
+    bool releaseBody(uint32_t bodyId);
+
+    // Bodies inside as of the last step, one bit per body id (for SceneSnapshot)
+    const std::vector<uint64_t> &getOccupancy() const { return insideBits; }
+    void setOccupancy(const uint64_t *words, size_t wordCount);
+
     void drawOBBDebug(Shader &shader);
 
+    const OBB &getBounds() const { return bounds; }
+    // Incremented whenever the bounds change, the trigger grid rebuilds when it sees a new value
+    uint32_t getVersion() const { return version; }
+
     // Reset the OBB bounds
-    void setBounds(const OBB &obb) { bounds = obb; }
+    void setBounds(const OBB &obb) {
+        bounds = obb;
+        version++;
+    }
 
     // Helper to set OBB from center, axes and half extents
     void setFromCenterAxesExtents(const glm::vec3 &center, const glm::vec3 axes[3], const glm::vec3 &halfExtents) {
-        bounds = OBB(center, axes, halfExtents);
+        setBounds(OBB(center, axes, halfExtents));
     }
 
 private:
-    std::unordered_set<GameObject *> objectsInside;
+    OBB bounds;
+    uint32_t version = 0;
 
-    bool isPointInside(const glm::vec3 &point) const;
+    // One bit per body id: inside at the last step, and inside during this step
+    std::vector<uint64_t> insideBits;
+    std::vector<uint64_t> nextInsideBits;
 };
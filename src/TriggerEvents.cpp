@@ -0,0 +1,61 @@
+#include "TriggerEvents.h"
+#include "Trigger.h"
+#include "GameObject.h"
+#include "PhysicsSystem.h"
+
+#include <algorithm>
+
+void TriggerEventQueue::setCollisionMask(GameObject *obj, uint32_t mask) {
+    if (!obj) return;
+    if (obj->triggerBodyId < 0) {
+        // Not a trigger body, nothing to coalesce with
+        obj->setCollisionMask(mask);
+        return;
+    }
+
+    size_t bodyId = static_cast<size_t>(obj->triggerBodyId);
+    if (bodyId >= pendingMasks.size()) {
+        pendingMasks.resize(bodyId + 1, 0);
+        hasPendingMask.resize(bodyId + 1, 0);
+    }
+    if (!hasPendingMask[bodyId]) {
+        hasPendingMask[bodyId] = 1;
+        pendingMaskBodies.push_back(static_cast<uint32_t>(bodyId));
+    }
+    pendingMasks[bodyId] = mask;
+}
+
+void TriggerEventQueue::dispatch(const std::vector<PoolPtr<Trigger>> &triggers, const std::vector<GameObject *> &bodies) {
+    // Events arrive sorted by trigger and body, keep that order inside each group
+    std::stable_partition(events.begin(), events.end(), [](const TriggerEvent &event) {
+        return event.type == TriggerEventType::Exit;
+        });
+
+    for (const TriggerEvent &event : events) {
+        Trigger *trigger = triggers[event.triggerId].get();
+        GameObject *obj = bodies[event.bodyId];
+        if (!obj) continue;
+        switch (event.type) {
+        case TriggerEventType::Exit:
+            if (trigger->onExit) trigger->onExit(obj);
+            break;
+        case TriggerEventType::Enter:
+            if (trigger->onEnter) trigger->onEnter(obj);
+            if (trigger->onInside) trigger->onInside(obj);
+            break;
+        case TriggerEventType::Inside:
+            if (trigger->onInside) trigger->onInside(obj);
+            break;
+        }
+    }
+    events.clear();
+
+    for (uint32_t bodyId : pendingMaskBodies) {
+        GameObject *obj = bodies[bodyId];
+        if (obj && obj->rigidBody && obj->rigidBody->collisionMask != pendingMasks[bodyId]) {
+            obj->setCollisionMask(pendingMasks[bodyId]);
+        }
+        hasPendingMask[bodyId] = 0;
+    }
+    pendingMaskBodies.clear();
+}
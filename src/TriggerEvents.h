@@ -0,0 +1,47 @@
+#pragma once
+
+#include "ObjectPool.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class GameObject;
+class Trigger;
+
+enum class TriggerEventType : uint8_t {
+    Exit,
+    Enter,
+    Inside
+};
+
+// A transition of one trigger body (dense id) in one trigger (index in the scene's trigger list)
+struct TriggerEvent {
+    uint32_t triggerId;
+    uint32_t bodyId;
+    TriggerEventType type;
+};
+
+// Trigger transitions recorded during detection and applied afterwards in a single dispatch phase.
+// Detection never runs callbacks, so it never sees an object that a callback (e.g. a teleport)
+// moved half way through the step.
+class TriggerEventQueue {
+public:
+    void push(const TriggerEvent &event) { events.push_back(event); }
+
+    // Collision mask change requested from a callback. Only the last request per body is kept
+    // and it is written once after dispatch, and only if it differs from the current mask.
+    void setCollisionMask(GameObject *obj, uint32_t mask);
+
+    // Runs the callbacks: every exit first, then enters and insides, each group ordered by
+    // trigger id and body id. Then applies the coalesced collision masks.
+    void dispatch(const std::vector<PoolPtr<Trigger>> &triggers, const std::vector<GameObject *> &bodies);
+
+private:
+    std::vector<TriggerEvent> events;
+
+    // Pending masks by body id, plus the ids that have one in the order they were first requested
+    std::vector<uint32_t> pendingMasks;
+    std::vector<uint8_t> hasPendingMask;
+    std::vector<uint32_t> pendingMaskBodies;
+};
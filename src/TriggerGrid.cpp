@@ -0,0 +1,44 @@
+#include "TriggerGrid.h"
+#include "Trigger.h"
+
+TriggerGrid::TriggerGrid(float cellSize) : cellSize(cellSize), invCellSize(1.0f / cellSize) {}
+
+void TriggerGrid::update(const std::vector<PoolPtr<Trigger>> &triggers) {
+    bool changed = builtVersions.size() != triggers.size();
+    for (size_t i = 0; !changed && i < triggers.size(); ++i) {
+        changed = builtTriggers[i] != triggers[i].get() || builtVersions[i] != triggers[i]->getVersion();
+    }
+    if (changed) {
+        rebuild(triggers);
+    }
+}
+
+void TriggerGrid::rebuild(const std::vector<PoolPtr<Trigger>> &triggers) {
+    cells.clear();
+    largeTriggers.clear();
+    builtTriggers.resize(triggers.size());
+    builtVersions.resize(triggers.size());
+
+    for (size_t i = 0; i < triggers.size(); ++i) {
+        builtTriggers[i] = triggers[i].get();
+        builtVersions[i] = triggers[i]->getVersion();
+        uint32_t id = static_cast<uint32_t>(i);
+
+        AABB bounds = triggers[i]->getBounds().getBounds();
+        glm::ivec3 minCell(cellCoord(bounds.min.x), cellCoord(bounds.min.y), cellCoord(bounds.min.z));
+        glm::ivec3 maxCell(cellCoord(bounds.max.x), cellCoord(bounds.max.y), cellCoord(bounds.max.z));
+        glm::ivec3 span = maxCell - minCell + glm::ivec3(1);
+        if (static_cast<int64_t>(span.x) * span.y * span.z > MaxCellsPerTrigger) {
+            largeTriggers.push_back(id);
+            continue;
+        }
+
+        for (int x = minCell.x; x <= maxCell.x; ++x) {
+            for (int y = minCell.y; y <= maxCell.y; ++y) {
+                for (int z = minCell.z; z <= maxCell.z; ++z) {
+                    cells[cellKey(x, y, z)].push_back(id);
+                }
+            }
+        }
+    }
+}
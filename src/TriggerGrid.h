@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Collider.h"
+#include "ObjectPool.h"
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+class Trigger;
+
+// Uniform hash grid over the world-space bounds of the scene triggers.
+// A trigger is listed in every cell its bounds touch, so a point only has to be tested
+// against the triggers of the one cell it falls into. The grid is rebuilt when a trigger
+// is added or moved, which only happens when portals are placed.
+class TriggerGrid {
+public:
+    explicit TriggerGrid(float cellSize = 2.0f);
+
+    // Rebuilds the cells if the trigger list or any trigger's bounds changed since the last call.
+    // Trigger ids are indices into this list (the dense array of the scene's trigger store).
+    void update(const std::vector<PoolPtr<Trigger>> &triggers);
+
+    // Calls fn(triggerId) for every trigger that may contain the point
+    template <typename Fn>
+    void query(const glm::vec3 &point, Fn &&fn) const {
+        for (uint32_t id : largeTriggers) {
+            fn(id);
+        }
+        auto it = cells.find(cellKey(cellCoord(point.x), cellCoord(point.y), cellCoord(point.z)));
+        if (it == cells.end()) return;
+        for (uint32_t id : it->second) {
+            fn(id);
+        }
+    }
+
+private:
+    // Triggers covering more cells than this are kept in largeTriggers and tested everywhere
+    static constexpr int MaxCellsPerTrigger = 512;
+
+    float cellSize;
+    float invCellSize;
+
+    std::unordered_map<uint64_t, std::vector<uint32_t>> cells;
+    std::vector<uint32_t> largeTriggers;
+    // Triggers and bounds versions the cells were built from
+    std::vector<const Trigger *> builtTriggers;
+    std::vector<uint32_t> builtVersions;
+
+    void rebuild(const std::vector<PoolPtr<Trigger>> &triggers);
+
+    int cellCoord(float value) const {
+        return static_cast<int>(std::floor(value * invCellSize));
+    }
+
+    static uint64_t cellKey(int x, int y, int z) {
+        // 21 bits per axis, wraps around every 2^21 cells which is far beyond any level
+        const uint64_t mask = (1u << 21) - 1;
+        return ((static_cast<uint64_t>(x) & mask) << 42) | ((static_cast<uint64_t>(y) & mask) << 21) | (static_cast<uint64_t>(z) & mask);
+    }
+};
@@ -1,7 +1,43 @@
 #include "Application.h"
+#include "MeshCache.h"
+#include "ObjLoader.h"
+#include <filesystem>
 #include <iostream>
+#include <string>
+
+// Cooks every model under resources/obj whose cooked file is missing or out of date
+static int cookMeshes() {
+    int failed = 0;
+    for (const auto &entry : std::filesystem::recursive_directory_iterator("resources/obj")) {
+        if (!entry.is_regular_file() || entry.path().extension() != ".obj") continue;
+        std::string path = entry.path().generic_string();
+        bool cooked = MeshCache::cookIfStale(path);
+        std::cout << (cooked ? "cooked  " : "FAILED  ") << MeshCache::cookedPathFor(path) << std::endl;
+        if (!cooked) failed++;
+    }
+    return failed == 0 ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--obj-parser" && i + 1 < argc) {
+            // --obj-parser stream|mapped|tinyobj picks the OBJ backend, to compare load times
+            ObjBackend backend;
+            if (ObjLoader::backendFromName(argv[++i], backend)) {
+                ObjLoader::setDefaultBackend(backend);
+            } else {
+                std::cerr << "Unknown OBJ parser: " << argv[i] << std::endl;
+            }
+        } else if (arg == "--no-mesh-cache") {
+            // Always parse the OBJ files, without reading or writing cooked meshes
+            MeshCache::setEnabled(false);
+        } else if (arg == "--cook-meshes") {
+            // Offline cooking, no window is opened
+            return cookMeshes();
+        }
+    }
 
-int main() {
     Application app(1920, 1080, "Portal Game");
 
     if (!app.initialize()) {
@@ -14,4 +50,3 @@ int main() {
 
     return 0;
 }
-